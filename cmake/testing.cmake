@@ -28,6 +28,34 @@ function(f3d_test_long_timeout)
   set_tests_properties(${ARGV0} PROPERTIES TIMEOUT 60)
 endfunction()
 
+function(f3d_test_other_baseline)
+  separate_arguments(ARGV4)
+  add_test(NAME ${ARGV0}
+           COMMAND $<TARGET_FILE:f3d>
+             ${ARGV4}
+             --dry-run
+             --resolution=${ARGV3}
+             --ref ${CMAKE_SOURCE_DIR}/data/baselines/${ARGV1}.png
+             --output ${CMAKE_BINARY_DIR}/Testing/Temporary/${ARGV0}.png
+             ${CMAKE_SOURCE_DIR}/data/testing/${ARGV2})
+  set_tests_properties(${ARGV0} PROPERTIES TIMEOUT 10)
+endfunction()
+
+# Compare to the output of another test rendering the same image with a different code path
+function(f3d_test_other_output)
+  separate_arguments(ARGV4)
+  add_test(NAME ${ARGV0}
+           COMMAND $<TARGET_FILE:f3d>
+             ${ARGV4}
+             --dry-run
+             --resolution=${ARGV3}
+             --ref ${CMAKE_BINARY_DIR}/Testing/Temporary/${ARGV1}.png
+             --output ${CMAKE_BINARY_DIR}/Testing/Temporary/${ARGV0}.png
+             ${CMAKE_SOURCE_DIR}/data/testing/${ARGV2})
+  set_tests_properties(${ARGV1} PROPERTIES FIXTURES_SETUP ${ARGV1})
+  set_tests_properties(${ARGV0} PROPERTIES TIMEOUT 10 FIXTURES_REQUIRED ${ARGV1})
+endfunction()
+
 function(f3d_test_interaction)
   separate_arguments(ARGV3)
   add_test(NAME ${ARGV0}
@@ -138,12 +166,40 @@ f3d_test(TestScalarsWithBar suzanne.ply "300,300" "-b --scalars=Normals --comp=0
 f3d_test(TestGLTFImporter WaterBottle.glb "300,300")
 f3d_test(TestGLTFImporterWithAnimation BoxAnimated.gltf "300,300")
 f3d_test(TestGLTFSkin SimpleSkin.gltf "300,300")
+# More joints than uniforms, compared to the ribbon skinned on the CPU
+f3d_test_no_baseline(TestGLTFSkinManyJointsPosed ManyJointsPosed.gltf "300,300" "--camera-position=0,0.57,3.5 --camera-focal-point=0,0.57,0 --camera-view-up=0,1,0")
+f3d_test_other_output(TestGLTFSkinManyJoints TestGLTFSkinManyJointsPosed ManyJoints.gltf "300,300" "--camera-position=0,0.57,3.5 --camera-focal-point=0,0.57,0 --camera-view-up=0,1,0")
 f3d_test(TestGLTFReaderWithAnimation BoxAnimated.gltf "300,300" "--geometry-only")
 f3d_test(TestDicom IM-0001-1983.dcm "300,300" "--scalars --roughness=1")
 f3d_test(TestMHD HeadMRVolume.mhd "300,300" "--scalars --roughness=1")
 f3d_test(TestVTICell waveletMaterial.vti "300,300" "--scalars=Material -c --roughness=1")
 f3d_test(TestSSAO suzanne.ply "300,300" "-u")
+f3d_test_no_baseline(TestSSAOResolution suzanne.ply "300,300" "-q --ssao-resolution=0.25 --ssao-kernel-size=16")
+# The fused post-processing must match the separate passes
+f3d_test_other_baseline(TestFusedToneMapping TestToneMapping suzanne.ply "300,300" "-t --fused-post-processing")
+f3d_test_other_baseline(TestFusedDepthPeelingToneMapping TestDepthPeelingToneMapping suzanne.ply "300,300" "--opacity=0.9 -pt --fused-post-processing")
+f3d_test_no_baseline(TestPostProcessing suzanne.ply "300,300" "-at")
+f3d_test_other_output(TestFusedPostProcessing TestPostProcessing suzanne.ply "300,300" "-at --fused-post-processing")
+f3d_test_no_baseline(TestFrameTimings suzanne.ply "300,300" "-q --frame-timings")
+# The cloud is a single octree node, rendered whole whatever the budget
+f3d_test_other_baseline(TestPointBudget TestPointCloud pointsCloud.vtp "300,300" "-o --point-size=20 --point-budget=100")
+# The nodes of the plane behind the camera are not selected, which must not change the image
+f3d_test_no_baseline(TestPointBudgetAllPoints pointsTwoPlanes.vtp "300,300" "-o --point-size=1.5 --camera-position=0.5,0.5,1.5 --camera-focal-point=0.5,0.5,0 --camera-view-up=0,1,0")
+f3d_test_other_output(TestPointBudgetOctree TestPointBudgetAllPoints pointsTwoPlanes.vtp "300,300" "-o --point-size=1.5 --point-budget=1000 --camera-position=0.5,0.5,1.5 --camera-focal-point=0.5,0.5,0 --camera-view-up=0,1,0")
+f3d_test_no_baseline(TestCompactVertexBuffers WaterBottle.glb "300,300" "--compact-vertex-buffers")
+f3d_test_no_baseline(TestCulling BoxAnimated.gltf "300,300" "--culling --culling-size=4 --frame-timings --benchmark=10")
+set_tests_properties(TestCulling PROPERTIES PASS_REGULAR_EXPRESSION "Culling: [1-9][0-9]* parts drawn, [0-9]+ culled")
+f3d_test_no_baseline(TestOcclusionCulling BoxAnimated.gltf "300,300" "--occlusion-culling --frame-timings --benchmark=10")
+set_tests_properties(TestOcclusionCulling PROPERTIES PASS_REGULAR_EXPRESSION "[0-9]+ culled, [0-9]+ occluded")
+f3d_test_no_baseline(TestDepthPrepass BoxAnimated.gltf "300,300" "--depth-prepass --benchmark=10")
+set_tests_properties(TestDepthPrepass PROPERTIES PASS_REGULAR_EXPRESSION "Depth prepass (used|not used), overdraw of [-+.e0-9]+")
+f3d_test_no_baseline(TestDepthPeelingBenchmark suzanne.ply "300,300" "-p --opacity=0.5 --frame-timings --benchmark=10")
+f3d_test_no_baseline(TestWeightedBlendingBenchmark suzanne.ply "300,300" "--weighted-blending --opacity=0.5 --frame-timings --benchmark=10")
+set_tests_properties(TestWeightedBlendingBenchmark PROPERTIES PASS_REGULAR_EXPRESSION "Weighted blending: [-+.e0-9]+ ms")
 f3d_test(TestDepthPeeling suzanne.ply "300,300" "-sp --opacity=0.9")
+# A single translucent layer is blended exactly by the weighted blending, like by depth peeling
+f3d_test_no_baseline(TestWeightedBlendingReference logo.tif "300,300" "-sy --up=-Y --opacity=0.5 -p")
+f3d_test_other_output(TestWeightedBlending TestWeightedBlendingReference logo.tif "300,300" "-sy --up=-Y --opacity=0.5 --weighted-blending")
 f3d_test(TestBackground suzanne.ply "300,300" "--bg-color=0.8,0.2,0.9")
 f3d_test(TestGridWithDepthPeeling suzanne.ply "300,300" "-gp --opacity 0.2")
 f3d_test(TestFilename suzanne.ply "300,300" "-n")
@@ -163,6 +219,10 @@ f3d_test(TestVolumeComp vase_4comp.vti "300,300" "-vb --comp=3")
 f3d_test(TestVolumeDirect vase_4comp.vti "300,300" "-vb --comp=-2")
 f3d_test(TestVolumeCells waveletArrays.vti "300,300" "-vb --cells")
 f3d_test(TestVolumeNonScalars waveletArrays.vti "300,300" "-vb --scalars=RandomPointScalars")
+f3d_test_no_baseline(TestVolumeBudgetCoarse HeadMRVolume.mhd "300,300" "-v --volume-budget=1 --camera-position=127.5,-400,127.5 --camera-view-up=0,0,1")
+# The bricks in the view fit in the budget at full resolution, which must not change the image
+f3d_test_no_baseline(TestVolumeBudgetWholeVolume slab.vti "300,300" "-v --camera-position=255.5,255.5,207 --camera-focal-point=255.5,255.5,0 --camera-view-up=0,1,0")
+f3d_test_other_output(TestVolumeBudget TestVolumeBudgetWholeVolume slab.vti "300,300" "-v --volume-budget=1 --camera-position=255.5,255.5,207 --camera-focal-point=255.5,255.5,0 --camera-view-up=0,1,0")
 f3d_test(TestTextures WaterBottle.glb "300,300" "--geometry-only --texture-material=${CMAKE_SOURCE_DIR}/data/testing/red.jpg --roughness=1 --metallic=1 --texture-base-color=${CMAKE_SOURCE_DIR}/data/testing/albedo.png --texture-normal=${CMAKE_SOURCE_DIR}/data/testing/normal.png --texture-emissive=${CMAKE_SOURCE_DIR}/data/testing/red.jpg --emissive-factor=0.1,0.1,0.1")
 f3d_test(TestMetaDataImporter BoxAnimated.gltf "300,300" "-m")
 f3d_test(TestMultiblockMetaData mb.vtm "300,300" "-m")
@@ -207,11 +267,27 @@ endif()
 
 if(VTK_VERSION VERSION_GREATER_EQUAL 9.0.20210429)
   f3d_test(TestGLTFMorph SimpleMorph.gltf "300,300")
+  # More morph targets than vertex attributes, compared to the targets applied on the CPU
+  f3d_test_no_baseline(TestGLTFMorphTargetsPosed MorphTargetsPosed.gltf "300,300" "--camera-position=0,0,4 --camera-focal-point=0,0,0 --camera-view-up=0,1,0")
+  f3d_test_other_output(TestGLTFMorphTargets TestGLTFMorphTargetsPosed MorphTargets.gltf "300,300" "--camera-position=0,0,4 --camera-focal-point=0,0,0 --camera-view-up=0,1,0")
+
+  # GPU deformation in the generic importer, compared to the poses computed on the CPU
+  f3d_test_no_baseline(TestGLTFReaderSkinPosed ManyJointsPosed.gltf "300,300" "--geometry-only --camera-position=0,0.57,3.5 --camera-focal-point=0,0.57,0 --camera-view-up=0,1,0")
+  f3d_test_other_output(TestGLTFReaderGPUSkin TestGLTFReaderSkinPosed ManyJoints.gltf "300,300" "--geometry-only --camera-position=0,0.57,3.5 --camera-focal-point=0,0.57,0 --camera-view-up=0,1,0")
+  f3d_test_no_baseline(TestGLTFReaderMorphPosed MorphTargetsPosed.gltf "300,300" "--geometry-only --camera-position=0,0,4 --camera-focal-point=0,0,0 --camera-view-up=0,1,0")
+  f3d_test_other_output(TestGLTFReaderGPUMorph TestGLTFReaderMorphPosed MorphTargets.gltf "300,300" "--geometry-only --camera-position=0,0,4 --camera-focal-point=0,0,0 --camera-view-up=0,1,0")
+
+  # Test GPU deformation in the generic importer, no baseline needed
+  f3d_test_no_baseline(TestVerboseGLTFReaderGPUDeformation SimpleSkin.gltf "300,300" "--geometry-only --verbose")
+  set_tests_properties(TestVerboseGLTFReaderGPUDeformation PROPERTIES PASS_REGULAR_EXPRESSION "Using GPU skinning and morphing")
 endif()
 
 if(VTK_VERSION VERSION_GREATER_EQUAL 9.0.20200527)
   f3d_test(TestEdges suzanne.ply "300,300" "-e")
   f3d_test(TestLineWidth cow.vtk "300,300" "-e --line-width=5")
+  # The single pass edges show the triangulation of the polygons, so they are compared on triangles
+  f3d_test_no_baseline(TestEdgesTriangles suzanne.stl "300,300" "-e")
+  f3d_test_other_output(TestSinglePassEdges TestEdgesTriangles suzanne.stl "300,300" "-e --single-pass-edges")
 endif()
 
 if(VTK_VERSION VERSION_GREATER 9.0.20210228)
@@ -265,6 +341,14 @@ f3d_test_interaction(TestInteractionPointCloud pointsCloud.vtp "300,300" "--poin
 f3d_test_interaction(TestInteractionHDRIBlur suzanne.ply "300,300" "--hdri=${CMAKE_SOURCE_DIR}/data/testing/palermo_park_1k.hdr") #U
 f3d_test_interaction(TestInteractionDirectory mb "300,300") #Right;Right;Right;Left;Up;
 f3d_test_interaction_no_baseline(TestInteractionAnimationNotStopped InterpolationTest.glb "300,300")#Space;Space;
+f3d_test_interaction_no_baseline(TestInteractionAnimationInterpolation InterpolationTest.glb "300,300" "--animation-interpolation --verbose")#Space;Space;
+set_tests_properties(TestInteractionAnimationInterpolation PROPERTIES PASS_REGULAR_EXPRESSION "Animation played at")
+# The time steps are sampled at 30 fps, rendering at 60 fps interpolates half way between them
+f3d_test_no_baseline(TestAnimationOutputInterpolation InterpolationTest.glb "300,300" "--animation-index=7 --animation-interpolation --animation-frame-rate=60 --verbose --animation-output=${CMAKE_BINARY_DIR}/Testing/Temporary/TestAnimationOutputInterpolation.png")
+set_tests_properties(TestAnimationOutputInterpolation PROPERTIES PASS_REGULAR_EXPRESSION "Animation frame 0.5: time [-+.e0-9]+ interpolated at 0.5 between time steps 0 and 1")
+# Rendering at 15 fps drops every other time step
+f3d_test_no_baseline(TestAnimationOutputFrameRate InterpolationTest.glb "300,300" "--animation-index=7 --animation-frame-rate=15 --verbose --animation-output=${CMAKE_BINARY_DIR}/Testing/Temporary/TestAnimationOutputFrameRate.png")
+set_tests_properties(TestAnimationOutputFrameRate PROPERTIES PASS_REGULAR_EXPRESSION "Animation frame 2: time step 2")
 f3d_test_interaction(TestInteractionResetCamera dragon.vtu "300,300")#MouseMovements;Return;
 f3d_test_interaction(TestInteractionTensorsCycleComp tensors.vti "300,300" "--scalars --comp=-2") #SYYYYYYYYYY
 f3d_test_interaction(TestInteractionCycleScalarsCompCheck dragon.vtu "300,300" "-b --scalars --comp=2") #S
@@ -289,6 +373,13 @@ set_tests_properties(TestOutputOutput PROPERTIES FIXTURES_REQUIRED OUTPUT_TEST)
 f3d_test_no_baseline(TestUnsupportedInputOutput unsupportedFile.dummy "300,300")
 set_tests_properties(TestUnsupportedInputOutput PROPERTIES PASS_REGULAR_EXPRESSION "No file loaded, no rendering performed")
 
+# Animation output test, the first frame of a turntable is the regular output
+f3d_test_no_baseline(TestTurntableOutput cow.vtp "300,300" "--turntable-frames=4 --animation-output=${CMAKE_BINARY_DIR}/Testing/Temporary/TestTurntableOutput.png")
+set_tests_properties(TestTurntableOutput PROPERTIES FIXTURES_SETUP TURNTABLE_OUTPUT_TEST)
+
+f3d_test_no_baseline(TestTurntableOutputOutput cow.vtp "300,300" "--ref=${CMAKE_BINARY_DIR}/Testing/Temporary/TestTurntableOutput_0000.png")
+set_tests_properties(TestTurntableOutputOutput PROPERTIES FIXTURES_REQUIRED TURNTABLE_OUTPUT_TEST)
+
 # No background option cannot be tested with reference
 f3d_test_no_baseline(TestOutputNoBackground cow.vtp "300,300" "--no-background")
 
@@ -310,6 +401,10 @@ set_tests_properties(TestVerbose PROPERTIES PASS_REGULAR_EXPRESSION "Number of p
 f3d_test_no_baseline(TestVerboseWrongArray dragon.vtu "300,300" "--scalars=dummy --verbose")
 set_tests_properties(TestVerboseWrongArray PROPERTIES PASS_REGULAR_EXPRESSION "Unknown scalar array: dummy")
 
+# Test the interactive proxy of a surface above the threshold, no baseline needed
+f3d_test_no_baseline(TestVerboseProxy dragon.vtu "300,300" "--proxy-threshold=100000 --verbose")
+set_tests_properties(TestVerboseProxy PROPERTIES PASS_REGULAR_EXPRESSION "Computing an interactive proxy in the background")
+
 # Default scalar array verbosity test
 f3d_test_no_baseline(TestVerboseDefaultScalar HeadMRVolume.mhd "300,300" "-s --verbose")
 set_tests_properties(TestVerboseDefaultScalar PROPERTIES PASS_REGULAR_EXPRESSION "Using default scalar array: MetaImage")
@@ -12,6 +12,10 @@
 #include <vtkRendererCollection.h>
 #include <vtkVersion.h>
 
+#include <algorithm>
+#include <cmath>
+#include <set>
+
 //----------------------------------------------------------------------------
 void F3DAnimationManager::Initialize(const F3DOptions& options, vtkImporter* importer, vtkRenderWindow* renWin, vtkF3DRenderer* renderer)
 {
@@ -110,7 +114,7 @@ void F3DAnimationManager::Initialize(const F3DOptions& options, vtkImporter* imp
     this->Importer->EnableAnimation(options.AnimationIndex);
   }
 
-  this->TimeSteps.clear();
+  std::set<double> timeSteps;
   this->TimeRange[0] = 0.0;
   this->TimeRange[1] = 0.0;
 
@@ -120,25 +124,33 @@ void F3DAnimationManager::Initialize(const F3DOptions& options, vtkImporter* imp
     if (this->Importer->IsAnimationEnabled(animIndex))
     {
       int nbTimeSteps;
-      vtkNew<vtkDoubleArray> timeSteps;
+      vtkNew<vtkDoubleArray> animTimeSteps;
 
 #if VTK_VERSION_NUMBER >= VTK_VERSION_CHECK(9, 0, 20201016)
       this->Importer->GetTemporalInformation(
-        animIndex, this->FrameRate, nbTimeSteps, this->TimeRange, timeSteps);
+        animIndex, this->FrameRate, nbTimeSteps, this->TimeRange, animTimeSteps);
 #else
       this->Importer->GetTemporalInformation(
-        animIndex, nbTimeSteps, this->TimeRange, timeSteps);
+        animIndex, nbTimeSteps, this->TimeRange, animTimeSteps);
 #endif
 
-      for (vtkIdType i = 0; i < timeSteps->GetNumberOfTuples(); i++)
+      for (vtkIdType i = 0; i < animTimeSteps->GetNumberOfTuples(); i++)
       {
-        this->TimeSteps.insert(timeSteps->GetValue(i));
+        timeSteps.insert(animTimeSteps->GetValue(i));
       }
     }
   }
 
-  this->CurrentTimeStep = std::begin(this->TimeSteps);
+  this->TimeSteps.assign(timeSteps.begin(), timeSteps.end());
+  this->CurrentTimeStep = 0;
+  this->CurrentFrame = 0.0;
   this->Playing = false;
+
+  this->Interpolate = options.AnimationInterpolation;
+  this->Verbose = options.Verbose;
+
+  // Interaction tests replay recorded timer events, they must not depend on the wall-clock time
+  this->FixedStep = !options.InteractionTestPlayFile.empty();
 }
 
 //----------------------------------------------------------------------------
@@ -160,42 +172,167 @@ void F3DAnimationManager::ToggleAnimation()
 
     vtkRenderWindowInteractor* interactor = this->RenderWindow->GetInteractor();
     interactor->RemoveObservers(vtkCommand::TimerEvent);
-    interactor->DestroyTimer();
+    if (this->TimerId > 0)
+    {
+      interactor->DestroyTimer(this->TimerId);
+      this->TimerId = 0;
+    }
 
     if (this->Playing)
     {
       vtkNew<vtkCallbackCommand> tickCallback;
       tickCallback->SetClientData(this);
-      tickCallback->SetCallback([](vtkObject*, unsigned long, void* clientData, void*) {
+      tickCallback->SetCallback([](vtkObject*, unsigned long, void* clientData, void* callData) {
         F3DAnimationManager* animMgr = static_cast<F3DAnimationManager*>(clientData);
+
+        // Ignore timers that are not ours, recorded timer events do not provide any id
+        int* timerId = static_cast<int*>(callData);
+        if (!animMgr->FixedStep && timerId && *timerId != animMgr->TimerId)
+        {
+          return;
+        }
         animMgr->Tick();
       });
       interactor->AddObserver(vtkCommand::TimerEvent, tickCallback);
-      interactor->CreateRepeatingTimer(1000.0 / this->FrameRate);
+
+      this->PlayStartTime = std::chrono::steady_clock::now();
+      this->PlayStartFrame = this->CurrentFrame;
+      this->RenderedFrames = 0;
+
+      if (this->FixedStep)
+      {
+        this->TimerId = interactor->CreateRepeatingTimer(1000.0 / this->FrameRate);
+      }
+      else
+      {
+        this->ScheduleTick(0.0);
+      }
+    }
+    else if (this->Verbose)
+    {
+      double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - this->PlayStartTime).count();
+      if (elapsed > 0.0)
+      {
+        double expectedFrames = std::floor(elapsed * this->FrameRate);
+        double droppedFrames = std::max(0.0, expectedFrames - this->RenderedFrames);
+        F3DLog::Print(F3DLog::Severity::Info, "Animation played at ",
+          this->RenderedFrames / elapsed, " fps for a target of ", this->FrameRate, " fps, ",
+          droppedFrames, " frame(s) dropped");
+      }
     }
   }
 }
 
+//----------------------------------------------------------------------------
+void F3DAnimationManager::ScheduleTick(double delay)
+{
+  // A one-shot timer is rearmed after each frame so that the interactor always gets a chance
+  // to process pending events between two frames, even when rendering is slower than the frame rate
+  vtkRenderWindowInteractor* interactor = this->RenderWindow->GetInteractor();
+  this->TimerId = interactor->CreateOneShotTimer(static_cast<unsigned long>(std::max(1.0, delay)));
+}
+
 //----------------------------------------------------------------------------
 void F3DAnimationManager::Tick()
 {
-  if (this->TimeSteps.size() > 0)
+  size_t nbTimeSteps = this->TimeSteps.size();
+  if (nbTimeSteps == 0)
   {
-    vtkProgressBarRepresentation* progressRep =
-      vtkProgressBarRepresentation::SafeDownCast(this->ProgressWidget->GetRepresentation());
-    progressRep->SetProgressRate(std::distance(std::begin(this->TimeSteps), this->CurrentTimeStep) /
-      static_cast<double>(this->TimeSteps.size() - 1));
-
-    this->Importer->UpdateTimeStep(*this->CurrentTimeStep);
-    this->RenderWindow->Render();
-    this->Renderer->InitializeCamera();
+    return;
+  }
 
-    this->CurrentTimeStep++;
+  if (this->FixedStep)
+  {
+    this->CurrentFrame = static_cast<double>(this->CurrentTimeStep);
+    this->ShowTime(this->TimeSteps[this->CurrentTimeStep]);
 
     // repeat
-    if (this->CurrentTimeStep == std::end(this->TimeSteps))
+    this->CurrentTimeStep = (this->CurrentTimeStep + 1) % nbTimeSteps;
+    return;
+  }
+
+  auto tickStart = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(tickStart - this->PlayStartTime).count();
+
+  // Frames that could not be rendered in time are simply skipped
+  this->CurrentFrame = std::fmod(
+    this->PlayStartFrame + elapsed * this->FrameRate, static_cast<double>(nbTimeSteps));
+  size_t timeStep = std::min(static_cast<size_t>(this->CurrentFrame), nbTimeSteps - 1);
+
+  if (this->Interpolate)
+  {
+    this->ShowTime(this->GetTimeAtFrame(this->CurrentFrame));
+  }
+  else if (timeStep != this->CurrentTimeStep || this->RenderedFrames == 0)
+  {
+    this->ShowTime(this->TimeSteps[timeStep]);
+  }
+  this->CurrentTimeStep = timeStep;
+
+  double tickDuration =
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tickStart).count();
+  this->ScheduleTick(1000.0 / this->FrameRate - tickDuration);
+}
+
+//----------------------------------------------------------------------------
+double F3DAnimationManager::GetTimeAtFrame(double frame) const
+{
+  size_t nbTimeSteps = this->TimeSteps.size();
+  size_t timeStep = std::min(static_cast<size_t>(std::max(0.0, frame)), nbTimeSteps - 1);
+  double alpha = frame - static_cast<double>(timeStep);
+  if (!this->Interpolate || timeStep + 1 >= nbTimeSteps || alpha <= 0.0)
+  {
+    return this->TimeSteps[timeStep];
+  }
+  return (1.0 - alpha) * this->TimeSteps[timeStep] + alpha * this->TimeSteps[timeStep + 1];
+}
+
+//----------------------------------------------------------------------------
+void F3DAnimationManager::LoadFrame(double frame)
+{
+  size_t nbTimeSteps = this->TimeSteps.size();
+  if (!this->Importer || nbTimeSteps == 0)
+  {
+    return;
+  }
+
+  this->CurrentFrame = frame;
+  this->CurrentTimeStep = std::min(static_cast<size_t>(std::max(0.0, frame)), nbTimeSteps - 1);
+  double time = this->GetTimeAtFrame(frame);
+
+  if (this->Verbose)
+  {
+    double alpha = frame - static_cast<double>(this->CurrentTimeStep);
+    if (this->Interpolate && alpha > 0.0 && this->CurrentTimeStep + 1 < nbTimeSteps)
+    {
+      F3DLog::Print(F3DLog::Severity::Info, "Animation frame ", frame, ": time ", time,
+        " interpolated at ", alpha, " between time steps ", this->CurrentTimeStep, " and ",
+        this->CurrentTimeStep + 1);
+    }
+    else
     {
-      this->CurrentTimeStep = std::begin(this->TimeSteps);
+      F3DLog::Print(F3DLog::Severity::Info, "Animation frame ", frame, ": time step ",
+        this->CurrentTimeStep);
     }
   }
+
+  this->Importer->UpdateTimeStep(time);
+}
+
+//----------------------------------------------------------------------------
+void F3DAnimationManager::ShowTime(double time)
+{
+  if (this->ProgressWidget)
+  {
+    vtkProgressBarRepresentation* progressRep =
+      vtkProgressBarRepresentation::SafeDownCast(this->ProgressWidget->GetRepresentation());
+    progressRep->SetProgressRate(
+      std::min(1.0, this->CurrentFrame / static_cast<double>(this->TimeSteps.size() - 1)));
+  }
+
+  this->Importer->UpdateTimeStep(time);
+  this->RenderWindow->Render();
+  this->Renderer->InitializeCamera();
+  this->RenderedFrames++;
 }
@@ -13,7 +13,8 @@
 #include <vtkProgressBarWidget.h>
 #include <vtkSmartPointer.h>
 
-#include <set>
+#include <chrono>
+#include <vector>
 
 class vtkF3DRenderer;
 class vtkImporter;
@@ -40,26 +41,73 @@ public:
    */
   bool IsPlaying() const { return Playing; }
 
+  /**
+   * Return the number of time steps of the enabled animations, 0 if there is none
+   */
+  size_t GetNumberOfTimeSteps() const { return TimeSteps.size(); }
+
+  /**
+   * Return the number of time steps per second
+   */
+  double GetFrameRate() const { return FrameRate; }
+
+  /**
+   * Update the importer to the provided frame without rendering, a fractional index in the
+   * time steps. In verbose mode, the time of the frame is printed.
+   */
+  void LoadFrame(double frame);
+
   /**
    * Finalize different objects managed by the animation manager
    */
   void Finalize();
 
 protected:
+  /**
+   * Called on each timer event while playing.
+   * The frame to show is computed from the elapsed wall-clock time, so frames are dropped
+   * when rendering cannot keep up with the frame rate instead of slowing down the animation.
+   * When playing an interaction test, a single time step is shown per call to stay deterministic.
+   */
   void Tick();
 
+  /**
+   * Return the time of a frame, interpolated between the two closest time steps
+   * when interpolation is enabled, the time of the previous time step otherwise
+   */
+  double GetTimeAtFrame(double frame) const;
+
+  /**
+   * Update the importer to the provided time and render it
+   */
+  void ShowTime(double time);
+
+  /**
+   * Arm the timer that will trigger the next tick
+   */
+  void ScheduleTick(double delay);
+
   vtkImporter* Importer = nullptr;
   vtkRenderWindow* RenderWindow = nullptr;
   vtkF3DRenderer* Renderer = nullptr;
 
-  std::set<double> TimeSteps;
-  std::set<double>::iterator CurrentTimeStep;
+  std::vector<double> TimeSteps;
+  size_t CurrentTimeStep = 0;
   double FrameRate = 30;
   double TimeRange[2] = { 0.0, 0.0 };
   bool Playing = false;
+  bool Interpolate = false;
+  bool FixedStep = false;
+  bool Verbose = false;
   int TimerId = 0;
   unsigned long ObserverId = 0;
 
+  // Playback clock, in frames, the current frame being a fractional index in TimeSteps
+  std::chrono::steady_clock::time_point PlayStartTime;
+  double PlayStartFrame = 0.0;
+  double CurrentFrame = 0.0;
+  unsigned int RenderedFrames = 0;
+
   vtkSmartPointer<vtkProgressBarWidget> ProgressWidget;
 
 private:
@@ -7,9 +7,11 @@
 #include "F3DReaderFactory.h"
 #include "F3DReaderInstantiator.h"
 #include "vtkF3DGenericImporter.h"
+#include "vtkF3DHDRICache.h"
 #include "vtkF3DInteractorEventRecorder.h"
 #include "vtkF3DInteractorStyle.h"
 #include "vtkF3DRendererWithColoring.h"
+#include "vtkF3DShaderCache.h"
 
 #include <vtkCallbackCommand.h>
 #include <vtkCamera.h>
@@ -29,6 +31,7 @@
 #include <vtksys/SystemTools.hxx>
 
 #include <algorithm>
+#include <cstring>
 
 #include "F3DIcon.h"
 
@@ -41,6 +44,7 @@ typedef struct ProgressDataStruct {
 F3DLoader::F3DLoader()
 {
   this->ReaderInstantiator = new F3DReaderInstantiator();
+  this->HDRICache = vtkSmartPointer<vtkF3DHDRICache>::New();
 }
 
 //----------------------------------------------------------------------------
@@ -49,6 +53,39 @@ F3DLoader::~F3DLoader()
   delete this->ReaderInstantiator;
 }
 
+//----------------------------------------------------------------------------
+std::string F3DLoader::GetCacheDirectory(const std::string& name)
+{
+  std::string directoryPath;
+#if defined(_WIN32)
+  const char* localAppData = vtksys::SystemTools::GetEnv("LOCALAPPDATA");
+  if (!localAppData || strlen(localAppData) == 0)
+  {
+    return std::string();
+  }
+  directoryPath = localAppData;
+#else
+  // Implementing XDG specifications
+  const char* xdgCacheHome = vtksys::SystemTools::GetEnv("XDG_CACHE_HOME");
+  if (xdgCacheHome && strlen(xdgCacheHome) > 0)
+  {
+    directoryPath = xdgCacheHome;
+  }
+  else
+  {
+    const char* home = vtksys::SystemTools::GetEnv("HOME");
+    if (!home)
+    {
+      return std::string();
+    }
+    directoryPath = home;
+    directoryPath += "/.cache";
+  }
+#endif
+  directoryPath += "/f3d/" + name + "/";
+  return directoryPath;
+}
+
 //----------------------------------------------------------------------------
 int F3DLoader::Start(int argc, char** argv)
 {
@@ -65,6 +102,19 @@ int F3DLoader::Start(int argc, char** argv)
     this->RenWin->SetMultiSamples(0); // Disable hardware antialiasing
     this->RenWin->SetWindowName(f3d::AppTitle.c_str());
 
+    if (this->CommandLineOptions.ShaderCache)
+    {
+      if (!vtkF3DShaderCache::Install(this->RenWin, F3DLoader::GetCacheDirectory("shaders")))
+      {
+        F3DLog::Print(F3DLog::Severity::Warning, "Shader cache is only available with OpenGL");
+      }
+    }
+
+    if (this->CommandLineOptions.HDRICache)
+    {
+      this->HDRICache->SetDirectory(F3DLoader::GetCacheDirectory("hdri"));
+    }
+
     vtkNew<vtkF3DInteractorStyle> style;
     style->SetAnimationManager(this->AnimationManager);
     // Will only be used when interacting with a animated file
@@ -104,7 +154,8 @@ int F3DLoader::Start(int argc, char** argv)
     style->AddObserver(F3DLoader::ToggleAnimationEvent, toggleAnimationCallback);
 
     // Offscreen rendering must be set before initializing interactor
-    if (!this->CommandLineOptions.Reference.empty() || !this->CommandLineOptions.Output.empty())
+    if (!this->CommandLineOptions.Reference.empty() || !this->CommandLineOptions.Output.empty() ||
+      !this->CommandLineOptions.AnimationOutput.empty() || this->CommandLineOptions.Benchmark > 0)
     {
       this->RenWin->OffScreenRenderingOn();
     }
@@ -182,6 +233,35 @@ int F3DLoader::Start(int argc, char** argv)
           EXIT_SUCCESS : EXIT_FAILURE;
       }
     }
+    else if (this->Options.Benchmark > 0)
+    {
+      if (!loaded)
+      {
+        F3DLog::Print(F3DLog::Severity::Warning, "No file loaded, no rendering performed");
+        retVal = EXIT_FAILURE;
+      }
+      else
+      {
+        retVal = F3DOffscreenRender::RenderBenchmark(this->RenWin, this->Options.Benchmark) ?
+          EXIT_SUCCESS : EXIT_FAILURE;
+        this->Renderer->DumpSceneState();
+      }
+    }
+    else if (!this->Options.AnimationOutput.empty())
+    {
+      if (!loaded)
+      {
+        F3DLog::Print(F3DLog::Severity::Warning, "No file loaded, no rendering performed");
+        retVal = EXIT_FAILURE;
+      }
+      else
+      {
+        retVal = F3DOffscreenRender::RenderAnimationOffScreen(this->RenWin, this->AnimationManager,
+                   this->Options.AnimationOutput, this->Options.TurntableFrames,
+                   this->Options.NoBackground, this->Options.AnimationFrameRate) ?
+                   EXIT_SUCCESS : EXIT_FAILURE;
+      }
+    }
     else if (!this->Options.Output.empty())
     {
       if (!loaded)
@@ -274,6 +354,7 @@ bool F3DLoader::LoadFile(int load)
   if (this->Renderer)
   {
     this->Renderer->ShowAxis(false);
+    this->Renderer->DetachHDRI();
     this->RenWin->RemoveRenderer(this->Renderer);
   }
 
@@ -329,6 +410,7 @@ bool F3DLoader::LoadFile(int load)
     if (!this->Options.NoRender)
     {
       this->Renderer = vtkSmartPointer<vtkF3DRenderer>::New();
+      this->Renderer->SetHDRICache(this->HDRICache);
       this->RenWin->AddRenderer(this->Renderer);
 
       fileInfo += "No file to load provided, please drop one into this window";
@@ -355,6 +437,7 @@ bool F3DLoader::LoadFile(int load)
     {
       fileInfo += " [UNSUPPORTED]";
       this->Renderer = vtkSmartPointer<vtkF3DRenderer>::New();
+      this->Renderer->SetHDRICache(this->HDRICache);
       this->RenWin->AddRenderer(this->Renderer);
       this->Renderer->Initialize(this->Options, fileInfo);
       this->Renderer->ShowOptions();
@@ -377,6 +460,7 @@ bool F3DLoader::LoadFile(int load)
     {
       this->Renderer = vtkSmartPointer<vtkF3DRenderer>::New();
     }
+    this->Renderer->SetHDRICache(this->HDRICache);
     this->RenWin->AddRenderer(this->Renderer);
     this->Renderer->Initialize(this->Options, fileInfo);
 
@@ -474,6 +558,8 @@ bool F3DLoader::LoadFile(int load)
       renWithColor->SetScalarBarActor(genericImporter->GetScalarBarActor());
       renWithColor->SetGeometryActor(genericImporter->GetGeometryActor());
       renWithColor->SetPointSpritesActor(genericImporter->GetPointSpritesActor());
+      renWithColor->SetProxyActor(genericImporter->GetProxyActor());
+      renWithColor->SetProxyGeometry(genericImporter->GetProxyGeometry());
       renWithColor->SetVolumeProp(genericImporter->GetVolumeProp());
       renWithColor->SetPolyDataMapper(genericImporter->GetPolyDataMapper());
       renWithColor->SetPointGaussianMapper(genericImporter->GetPointGaussianMapper());
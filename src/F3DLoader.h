@@ -13,6 +13,7 @@
 
 #include "F3DAnimationManager.h"
 
+class vtkF3DHDRICache;
 class vtkF3DRenderer;
 class vtkImporter;
 class F3DReaderInstantiator;
@@ -70,6 +71,12 @@ protected:
   static vtkSmartPointer<vtkImporter> GetImporter(
     const F3DOptions& options, const std::string& fileName);
 
+  /**
+   * Get the directory where F3D caches the named data, following the XDG specification,
+   * or an empty string if it cannot be determined
+   */
+  static std::string GetCacheDirectory(const std::string& name);
+
   std::vector<std::string> FilesList;
   int CurrentFileIndex = 0;
   F3DOptionsParser Parser;
@@ -79,6 +86,7 @@ protected:
   vtkSmartPointer<vtkF3DRenderer> Renderer;
   vtkSmartPointer<vtkImporter> Importer;
   vtkSmartPointer<vtkRenderWindow> RenWin;
+  vtkSmartPointer<vtkF3DHDRICache> HDRICache;
   F3DReaderInstantiator* ReaderInstantiator;
 
 private:
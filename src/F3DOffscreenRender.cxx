@@ -1,15 +1,148 @@
 #include "F3DOffscreenRender.h"
 
+#include <vtkCamera.h>
+#include <vtkErrorCode.h>
+#include <vtkImageData.h>
 #include <vtkImageDifference.h>
 #include <vtkNew.h>
+#include <vtkOpenGLFramebufferObject.h>
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkOpenGLState.h>
 #include <vtkPNGReader.h>
 #include <vtkPNGWriter.h>
 #include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkRendererCollection.h>
+#include <vtkSmartPointer.h>
+#include <vtkVersion.h>
 #include <vtkWindowToImageFilter.h>
+#include <vtk_glew.h>
 #include <vtksys/SystemTools.hxx>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "F3DAnimationManager.h"
 #include "F3DLog.h"
 
+namespace
+{
+//----------------------------------------------------------------------------
+// Encode RGBA images into png files using a pool of worker threads.
+// The number of pending images is bounded so that memory usage stays under control
+// when encoding is slower than rendering.
+class F3DPNGEncoderPool
+{
+public:
+  F3DPNGEncoderPool(unsigned int nbThreads, size_t maxPendingImages)
+    : MaxPendingImages(maxPendingImages)
+  {
+    for (unsigned int i = 0; i < nbThreads; i++)
+    {
+      this->Workers.emplace_back(&F3DPNGEncoderPool::Run, this);
+    }
+  }
+
+  ~F3DPNGEncoderPool() { this->Wait(); }
+
+  // Queue an image to encode, blocks while too many images are pending
+  void Push(vtkSmartPointer<vtkImageData> image, const std::string& fileName, bool keepAlpha)
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->CanPush.wait(lock, [this] { return this->Jobs.size() < this->MaxPendingImages; });
+    this->Jobs.push_back({ image, fileName, keepAlpha });
+    this->CanPop.notify_one();
+  }
+
+  // Wait for all images to be written, returns false if any of them failed
+  bool Wait()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Done = true;
+    }
+    this->CanPop.notify_all();
+    for (std::thread& worker : this->Workers)
+    {
+      worker.join();
+    }
+    this->Workers.clear();
+    return this->Success;
+  }
+
+private:
+  struct Job
+  {
+    vtkSmartPointer<vtkImageData> Image;
+    std::string FileName;
+    bool KeepAlpha;
+  };
+
+  void Run()
+  {
+    for (;;)
+    {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(this->Mutex);
+        this->CanPop.wait(lock, [this] { return this->Done || !this->Jobs.empty(); });
+        if (this->Jobs.empty())
+        {
+          return;
+        }
+        job = std::move(this->Jobs.front());
+        this->Jobs.pop_front();
+      }
+      this->CanPush.notify_one();
+
+      vtkSmartPointer<vtkImageData> image = job.Image;
+      if (!job.KeepAlpha)
+      {
+        int* dims = job.Image->GetDimensions();
+        size_t nbPixels = static_cast<size_t>(dims[0]) * dims[1];
+        image = vtkSmartPointer<vtkImageData>::New();
+        image->SetDimensions(dims);
+        image->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+        const unsigned char* src = static_cast<unsigned char*>(job.Image->GetScalarPointer());
+        unsigned char* dst = static_cast<unsigned char*>(image->GetScalarPointer());
+        for (size_t i = 0; i < nbPixels; i++)
+        {
+          std::copy(src + 4 * i, src + 4 * i + 3, dst + 3 * i);
+        }
+      }
+
+      vtkNew<vtkPNGWriter> writer;
+      writer->SetInputData(image);
+      writer->SetFileName(job.FileName.c_str());
+      writer->Write();
+      if (writer->GetErrorCode() != vtkErrorCode::NoError)
+      {
+        this->Success = false;
+      }
+    }
+  }
+
+  std::vector<std::thread> Workers;
+  std::deque<Job> Jobs;
+  std::mutex Mutex;
+  std::condition_variable CanPush;
+  std::condition_variable CanPop;
+  size_t MaxPendingImages;
+  bool Done = false;
+  std::atomic<bool> Success{ true };
+};
+}
+
 //----------------------------------------------------------------------------
 bool F3DOffscreenRender::RenderOffScreen(
   vtkRenderWindow* renWin, const std::string& output, bool noBg)
@@ -31,6 +164,192 @@ bool F3DOffscreenRender::RenderOffScreen(
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool F3DOffscreenRender::RenderAnimationOffScreen(vtkRenderWindow* renWin,
+  F3DAnimationManager& animMgr, const std::string& output, int turntableFrames, bool noBg,
+  double frameRate)
+{
+  vtkOpenGLRenderWindow* glRenWin = vtkOpenGLRenderWindow::SafeDownCast(renWin);
+  vtkRenderer* renderer = renWin->GetRenderers()->GetFirstRenderer();
+  if (!glRenWin || !renderer)
+  {
+    F3DLog::Print(F3DLog::Severity::Error, "Cannot export the animation, no OpenGL rendering available");
+    return false;
+  }
+
+  // With a frame rate, the time steps are sampled at that rate, the animation manager
+  // interpolating or dropping them, instead of rendering each of them once
+  size_t nbTimeSteps = animMgr.GetNumberOfTimeSteps();
+  size_t nbAnimationFrames = nbTimeSteps;
+  double stepsPerFrame = 1.0;
+  if (frameRate > 0.0 && nbTimeSteps > 1)
+  {
+    stepsPerFrame = animMgr.GetFrameRate() / frameRate;
+    nbAnimationFrames = static_cast<size_t>(std::floor((nbTimeSteps - 1) / stepsPerFrame)) + 1;
+  }
+
+  // When both are provided, the animation is stretched over the turntable frames or conversely
+  size_t nbFrames =
+    std::max(nbAnimationFrames, static_cast<size_t>(std::max(turntableFrames, 1)));
+  double azimuthStep = turntableFrames > 0 ? 360.0 / nbFrames : 0.0;
+
+  std::string fullPath = vtksys::SystemTools::CollapseFullPath(output);
+  std::string directory = vtksys::SystemTools::GetFilenamePath(fullPath);
+  std::string baseName = vtksys::SystemTools::GetFilenameWithoutLastExtension(fullPath);
+  std::string extension = vtksys::SystemTools::GetFilenameLastExtension(fullPath);
+  if (extension.empty())
+  {
+    extension = ".png";
+  }
+  auto getFrameFileName = [&](size_t frame) {
+    std::stringstream ss;
+    ss << directory << "/" << baseName << "_" << std::setw(4) << std::setfill('0') << frame
+       << extension;
+    return ss.str();
+  };
+
+  int* size = renWin->GetSize();
+  int width = size[0];
+  int height = size[1];
+  size_t bufferSize = static_cast<size_t>(width) * height * 4;
+
+  // Two pixel pack buffers are used alternatively, so the readback of a frame
+  // is performed by the driver while the next frame is rendered
+  glRenWin->MakeCurrent();
+  GLuint pixelBuffers[2];
+  glGenBuffers(2, pixelBuffers);
+  for (GLuint pixelBuffer : pixelBuffers)
+  {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, bufferSize, nullptr, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  unsigned int nbCores = std::thread::hardware_concurrency();
+  unsigned int nbThreads = nbCores > 1 ? nbCores - 1 : 1;
+  F3DPNGEncoderPool encoderPool(nbThreads, 2 * nbThreads);
+
+  // The pixels are read from the framebuffer holding the final image directly into a pixel
+  // pack buffer, so that the call returns without waiting for the rendering to finish
+  vtkOpenGLState* ostate = glRenWin->GetState();
+  auto readFrame = [&](size_t frame) {
+    ostate->PushReadFramebufferBinding();
+#if VTK_VERSION_NUMBER >= VTK_VERSION_CHECK(9, 0, 20201026)
+    vtkOpenGLFramebufferObject* displayFramebuffer = glRenWin->GetDisplayFramebuffer();
+    displayFramebuffer->Bind(GL_READ_FRAMEBUFFER);
+    displayFramebuffer->ActivateReadBuffer(0);
+#else
+    glReadBuffer(glRenWin->GetFrontLeftBuffer());
+#endif
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[frame % 2]);
+    ostate->vtkglPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    ostate->PopReadFramebufferBinding();
+  };
+
+  auto encodeFrame = [&](size_t frame) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[frame % 2]);
+    const unsigned char* pixels = static_cast<const unsigned char*>(
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bufferSize, GL_MAP_READ_BIT));
+    if (!pixels)
+    {
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      return false;
+    }
+
+    vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+    image->SetDimensions(width, height, 1);
+    image->AllocateScalars(VTK_UNSIGNED_CHAR, 4);
+    std::memcpy(image->GetScalarPointer(), pixels, bufferSize);
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    encoderPool.Push(image, getFrameFileName(frame), noBg);
+    return true;
+  };
+
+  bool success = true;
+  for (size_t frame = 0; frame < nbFrames && success; frame++)
+  {
+    if (nbTimeSteps > 0)
+    {
+      animMgr.LoadFrame(static_cast<double>(frame * nbAnimationFrames / nbFrames) * stepsPerFrame);
+    }
+    if (frame > 0 && azimuthStep != 0.0)
+    {
+      renderer->GetActiveCamera()->Azimuth(azimuthStep);
+      renderer->ResetCameraClippingRange();
+    }
+    renWin->Render();
+
+    readFrame(frame);
+
+    if (frame > 0)
+    {
+      success = encodeFrame(frame - 1);
+    }
+  }
+  if (success)
+  {
+    success = encodeFrame(nbFrames - 1);
+  }
+
+  glDeleteBuffers(2, pixelBuffers);
+
+  if (!success)
+  {
+    F3DLog::Print(F3DLog::Severity::Error, "Cannot read back the rendered animation frames");
+  }
+  if (!encoderPool.Wait())
+  {
+    F3DLog::Print(F3DLog::Severity::Error, "Cannot write the animation frames into ", directory);
+    success = false;
+  }
+  return success;
+}
+
+//----------------------------------------------------------------------------
+bool F3DOffscreenRender::RenderBenchmark(vtkRenderWindow* renWin, int frames)
+{
+  vtkRenderer* renderer = renWin->GetRenderers()->GetFirstRenderer();
+  if (!renderer || frames <= 0)
+  {
+    F3DLog::Print(F3DLog::Severity::Error, "Cannot run the benchmark, no renderer or no frames");
+    return false;
+  }
+
+  // the first frame compiles the shaders and uploads the buffers, it is not measured
+  renWin->Render();
+  renWin->WaitForCompletion();
+
+  double azimuthStep = 360.0 / frames;
+  double totalTime = 0.0;
+  double minTime = VTK_DOUBLE_MAX;
+  double maxTime = 0.0;
+  for (int frame = 0; frame < frames; frame++)
+  {
+    renderer->GetActiveCamera()->Azimuth(azimuthStep);
+    renderer->ResetCameraClippingRange();
+
+    auto start = std::chrono::steady_clock::now();
+    renWin->Render();
+    renWin->WaitForCompletion();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    totalTime += elapsed.count();
+    minTime = std::min(minTime, elapsed.count());
+    maxTime = std::max(maxTime, elapsed.count());
+  }
+
+  double averageTime = totalTime / frames;
+  F3DLog::Print(F3DLog::Severity::Info, "Benchmark of ", frames, " frames: ", averageTime,
+    " ms per frame (", 1000.0 / averageTime, " fps), min ", minTime, " ms, max ", maxTime,
+    " ms\n");
+  return true;
+}
+
 //----------------------------------------------------------------------------
 bool F3DOffscreenRender::RenderTesting(vtkRenderWindow* renWin, const std::string& reference,
   double threshold, const std::string& output)
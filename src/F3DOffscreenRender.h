@@ -9,6 +9,7 @@
 
 #include <string>
 
+class F3DAnimationManager;
 class vtkRenderWindow;
 
 class F3DOffscreenRender
@@ -20,6 +21,28 @@ public:
    */
   static bool RenderOffScreen(vtkRenderWindow* renWin, const std::string& output, bool noBg = false);
 
+  /**
+   * Render each frame of the animation managed by animMgr into numbered png files
+   * derived from the output provided, eg: output_0000.png, output_0001.png, ...
+   * If turntableFrames is positive, the camera also performs a full rotation around its focal
+   * point, using at least turntableFrames frames.
+   * If frameRate is positive, the animation is sampled at this number of frames per second
+   * instead of rendering each time step once.
+   * Frames are read back asynchronously and encoded by a pool of worker threads while
+   * the next frames are rendered.
+   * Returns true if sucessful, false otherwise.
+   */
+  static bool RenderAnimationOffScreen(vtkRenderWindow* renWin, F3DAnimationManager& animMgr,
+    const std::string& output, int turntableFrames = 0, bool noBg = false,
+    double frameRate = 0.0);
+
+  /**
+   * Render renWin frames times while the camera performs a full rotation around its focal
+   * point, waiting for each frame to be finished, and print the frame times.
+   * Returns true if sucessful, false otherwise.
+   */
+  static bool RenderBenchmark(vtkRenderWindow* renWin, int frames);
+
   /**
    * Render renWin and compare with reference using provided threshold. Output png is generated in case of failure.
    * Returns true if sucessful, false otherwise.
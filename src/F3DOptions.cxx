@@ -190,13 +190,27 @@ F3DOptions ConfigurationOptions::GetOptionsFromArgs(std::vector<std::string>& in
     this->DeclareOption(grp1, "extensions-list", "", "Print the list of supported extensions");
     this->DeclareOption(grp1, "verbose", "", "Enable verbose mode", options.Verbose);
     this->DeclareOption(grp1, "no-render", "", "Verbose mode without any rendering, only for the first file", options.NoRender);
+    this->DeclareOption(grp1, "shader-cache", "", "Store the compiled shaders on disk to speed up the next starts", options.ShaderCache);
+    this->DeclareOption(grp1, "hdri-cache", "", "Store the decoded and blurred HDRI on disk to speed up the next starts", options.HDRICache);
     this->DeclareOption(grp1, "axis", "x", "Show axes", options.Axis);
     this->DeclareOption(grp1, "grid", "g", "Show grid", options.Grid);
     this->DeclareOption(grp1, "edges", "e", "Show cell edges", options.Edges);
+    this->DeclareOption(grp1, "single-pass-edges", "", "Draw the cell edges in the same pass as the surface", options.SinglePassEdges);
+    this->DeclareOption(grp1, "compact-vertex-buffers", "", "Upload compact positions, normals, tangents and texture coordinates", options.CompactVertexBuffers);
+    this->DeclareOption(grp1, "culling", "", "Do not render the parts out of the view", options.Culling);
+    this->DeclareOption(grp1, "culling-size", "", "Size in pixels under which the parts are not rendered while interacting, with culling", options.CullingSize, true, true, "<pixels>");
+    this->DeclareOption(grp1, "occlusion-culling", "", "Do not render the parts hidden by others in the previous frames", options.OcclusionCulling);
+    this->DeclareOption(grp1, "depth-prepass", "", "Render the depth of the opaque parts before shading them when the overdraw is high", options.DepthPrepass);
+    this->DeclareOption(grp1, "proxy-threshold", "", "Number of cells or points above which a simplified proxy is rendered while interacting, 0 to never use it", options.ProxyThreshold, true, true, "<count>");
     this->DeclareOption(grp1, "trackball", "k", "Enable trackball interaction", options.Trackball);
     this->DeclareOption(grp1, "progress", "", "Show progress bar", options.Progress);
     this->DeclareOption(grp1, "up", "", "Up direction", options.Up, true, "[-X|+X|-Y|+Y|-Z|+Z]");
     this->DeclareOption(grp1, "animation-index", "", "Select animation to show", options.AnimationIndex, true, true, "<index>");
+    this->DeclareOption(grp1, "animation-interpolation", "", "Interpolate between animation time steps", options.AnimationInterpolation);
+    this->DeclareOption(grp1, "animation-output", "", "Render each animation frame to numbered files", options.AnimationOutput, false, false, "<png file>");
+    this->DeclareOption(grp1, "turntable-frames", "", "Number of frames of a camera turntable when rendering animation frames", options.TurntableFrames, true, true, "<frames>");
+    this->DeclareOption(grp1, "animation-frame-rate", "", "Number of frames per second when rendering animation frames", options.AnimationFrameRate, true, true, "<fps>");
+    this->DeclareOption(grp1, "benchmark", "", "Render a camera turntable offscreen and print the frame times", options.Benchmark, true, true, "<frames>");
 #if VTK_VERSION_NUMBER > VTK_VERSION_CHECK(9, 0, 20210228)
     this->DeclareOption(grp1, "camera-index", "", "Select the camera to use", options.CameraIndex, true, true, "<index>");
 #endif
@@ -207,6 +221,7 @@ F3DOptions ConfigurationOptions::GetOptionsFromArgs(std::vector<std::string>& in
     auto grp2 = cxxOptions.add_options("Material");
     this->DeclareOption(grp2, "point-sprites", "o", "Show sphere sprites instead of geometry", options.PointSprites);
     this->DeclareOption(grp2, "point-size", "", "Point size when showing vertices or point sprites", options.PointSize, true, true, "<size>");
+    this->DeclareOption(grp2, "point-budget", "", "Maximum number of point sprites rendered, selected depending on the view, 0 to render all of them", options.PointBudget, true, true, "<count>");
     this->DeclareOption(grp2, "line-width", "", "Line width when showing edges", options.LineWidth, true, true, "<width>");
     this->DeclareOption(grp2, "color", "", "Solid color", options.SolidColor, true, true, "<R,G,B>");
     this->DeclareOption(grp2, "opacity", "", "Opacity", options.Opacity, true, true, "<opacity>");
@@ -224,10 +239,12 @@ F3DOptions ConfigurationOptions::GetOptionsFromArgs(std::vector<std::string>& in
     this->DeclareOption(grp3, "bg-color", "", "Background color", options.BackgroundColor, true, true, "<R,G,B>");
     this->DeclareOption(grp3, "resolution", "", "Window resolution", options.WindowSize, true, true, "<width,height>");
     this->DeclareOption(grp3, "fps", "z", "Display frame per second", options.FPS);
+    this->DeclareOption(grp3, "frame-timings", "", "Display the GPU time of each render pass with the frame rate", options.FrameTimings);
     this->DeclareOption(grp3, "filename", "n", "Display filename", options.Filename);
     this->DeclareOption(grp3, "metadata", "m", "Display file metadata", options.MetaData);
     this->DeclareOption(grp3, "fullscreen", "f", "Full screen", options.FullScreen);
     this->DeclareOption(grp3, "blur-background", "u", "Blur background", options.BlurBackground);
+    this->DeclareOption(grp3, "prefiltered-blur", "", "Blur the background using a HDRI blurred once instead of blurring each frame", options.PrefilteredBlur);
 
     auto grp4 = cxxOptions.add_options("Scientific visualization");
     this->DeclareOptionWithImplicitValue(grp4, "scalars", "s", "Color by scalars", options.Scalars, std::string(""), true, true, "<array_name>");
@@ -239,6 +256,7 @@ F3DOptions ConfigurationOptions::GetOptionsFromArgs(std::vector<std::string>& in
       true, "<color_list>");
     this->DeclareOption(grp4, "volume", "v", "Show volume if the file is compatible", options.Volume);
     this->DeclareOption(grp4, "inverse", "i", "Inverse opacity function for volume rendering", options.InverseOpacityFunction);
+    this->DeclareOption(grp4, "volume-budget", "", "Maximum size in MiB of the volume sent to the GPU, lower resolutions of the visible part being used when bigger, 0 to send the whole volume", options.VolumeBudget, true, true, "<MiB>");
 
     auto grpCamera = cxxOptions.add_options("Camera");
     this->DeclareOption(grpCamera, "camera-position", "", "Camera position", options.CameraPosition, false, true, "<X,Y,Z>");
@@ -257,9 +275,13 @@ F3DOptions ConfigurationOptions::GetOptionsFromArgs(std::vector<std::string>& in
 
     auto grp6 = cxxOptions.add_options("PostFX (OpenGL)");
     this->DeclareOption(grp6, "depth-peeling", "p", "Enable depth peeling", options.DepthPeeling);
+    this->DeclareOption(grp6, "weighted-blending", "", "Enable weighted blended order independent translucency", options.WeightedBlending);
     this->DeclareOption(grp6, "ssao", "q", "Enable Screen-Space Ambient Occlusion", options.SSAO);
+    this->DeclareOption(grp6, "ssao-resolution", "", "Resolution of the ambient occlusion, relative to the window size", options.SSAOResolution, true, true, "<scale>");
+    this->DeclareOption(grp6, "ssao-kernel-size", "", "Number of samples of the ambient occlusion kernel", options.SSAOKernelSize, true, true, "<samples>");
     this->DeclareOption(grp6, "fxaa", "a", "Enable Fast Approximate Anti-Aliasing", options.FXAA);
     this->DeclareOption(grp6, "tone-mapping", "t", "Enable Tone Mapping", options.ToneMapping);
+    this->DeclareOption(grp6, "fused-post-processing", "", "Apply the tone mapping and FXAA in a single pass", options.FusedPostProcessing);
 
     auto grp7 = cxxOptions.add_options("Testing");
     this->DeclareOption(grp7, "ref", "", "Reference", options.Reference, false, false, "<png file>");
@@ -21,9 +21,16 @@ struct F3DOptions
   bool Cells = false;
   bool Denoise = false;
   bool DepthPeeling = false;
+  bool WeightedBlending = false;
   bool DryRun = false;
   bool Edges = false;
+  bool SinglePassEdges = false;
+  bool CompactVertexBuffers = false;
+  bool Culling = false;
+  bool OcclusionCulling = false;
+  bool DepthPrepass = false;
   bool FPS = false;
+  bool FrameTimings = false;
   bool Filename = false;
   bool MetaData = false;
   bool FXAA = false;
@@ -34,30 +41,45 @@ struct F3DOptions
   bool SSAO = false;
   bool Verbose = false;
   bool NoRender = false;
+  bool ShaderCache = false;
+  bool HDRICache = false;
   bool PointSprites = false;
   bool FullScreen = false;
   bool ToneMapping = false;
+  bool FusedPostProcessing = false;
   bool Volume = false;
   bool InverseOpacityFunction = false;
+  int VolumeBudget = 0;
   bool NoBackground = false;
   bool BlurBackground = false;
+  bool PrefilteredBlur = false;
   bool Trackball = false;
+  bool AnimationInterpolation = false;
   double CameraViewAngle;
   double CameraAzimuthAngle = 0.0;
   double CameraElevationAngle = 0.0;
   double Metallic = 0.0;
   double Opacity = 1.0;
   double PointSize = 10.0;
+  int PointBudget = 0;
+  double CullingSize = 0.0;
+  int ProxyThreshold = 2000000;
   double LineWidth = 1.0;
   double RefThreshold = 0.1;
   double Roughness = 0.3;
+  double SSAOResolution = 1.0;
   int Component = -1;
   int Samples = 5;
+  int SSAOKernelSize = 200;
   std::string Up = "+Y";
   int AnimationIndex = -1;
+  int TurntableFrames = 0;
+  double AnimationFrameRate = 0.0;
+  int Benchmark = 0;
   int CameraIndex = -1;
   std::string UserConfigFile = "";
   std::string Output = "";
+  std::string AnimationOutput = "";
   std::string Reference = "";
   std::string Scalars = f3d::F3DReservedString;
   std::string InteractionTestRecordFile = "";
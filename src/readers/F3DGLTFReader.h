@@ -9,7 +9,8 @@
 
 #include "F3DReaderFactory.h"
 
-#include <vtkGLTFReader.h>
+#include "vtkF3DGLTFReader.h"
+
 #include <vtkGLTFImporter.h>
 
 class F3DGLTFReader : public F3DReader
@@ -41,7 +42,7 @@ public:
    */
   vtkSmartPointer<vtkAlgorithm> CreateGeometryReader(const std::string& fileName) const override
   {
-    vtkSmartPointer<vtkGLTFReader> reader = vtkSmartPointer<vtkGLTFReader>::New();
+    vtkSmartPointer<vtkF3DGLTFReader> reader = vtkSmartPointer<vtkF3DGLTFReader>::New();
     reader->SetFileName(fileName.c_str());
 
     // Enable all animations in the GLTFReader
@@ -9,7 +9,7 @@
 
 #include "F3DReaderFactory.h"
 
-#include <vtkPTSReader.h>
+#include "vtkF3DPTSReader.h"
 
 class F3DPTSReader : public F3DReader
 {
@@ -40,8 +40,8 @@ public:
    */
   vtkSmartPointer<vtkAlgorithm> CreateGeometryReader(const std::string& fileName) const override
   {
-    vtkSmartPointer<vtkPTSReader> reader = vtkSmartPointer<vtkPTSReader>::New();
-    reader->SetFileName(fileName.c_str());
+    vtkSmartPointer<vtkF3DPTSReader> reader = vtkSmartPointer<vtkF3DPTSReader>::New();
+    reader->SetFileName(fileName);
     return reader;
   }
 };
@@ -0,0 +1,268 @@
+#include "vtkF3DCuller.h"
+
+#include "vtkF3DPointCloudOctree.h"
+
+#include <vtkCamera.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkProp.h>
+#include <vtkRenderer.h>
+
+#include <algorithm>
+#include <cmath>
+
+vtkStandardNewMacro(vtkF3DCuller);
+
+namespace
+{
+// Nodes with less items than this are not subdivided
+constexpr int LeafSize = 4;
+
+// Maximum move of the camera between two frames to use the occlusion of the previous frame,
+// relative to the size of the scene, and maximum rotation in degrees
+constexpr double MaxCameraMove = 0.01;
+constexpr double MaxCameraRotation = 1.0;
+
+double GetDiagonal(const double bounds[6])
+{
+  double dx = bounds[1] - bounds[0];
+  double dy = bounds[3] - bounds[2];
+  double dz = bounds[5] - bounds[4];
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DCuller::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "MinimumScreenSize: " << this->MinimumScreenSize << "\n";
+  os << indent << "Interactive: " << (this->Interactive ? "true" : "false") << "\n";
+  os << indent << "NumberOfDrawnProps: " << this->NumberOfDrawnProps << "\n";
+  os << indent << "OcclusionCulling: " << (this->OcclusionCulling ? "true" : "false") << "\n";
+  os << indent << "NumberOfCulledProps: " << this->NumberOfCulledProps << "\n";
+  os << indent << "NumberOfOccludedProps: " << this->NumberOfOccludedProps << "\n";
+}
+
+//----------------------------------------------------------------------------
+double vtkF3DCuller::Cull(
+  vtkRenderer* ren, vtkProp** propList, int& listLength, int& vtkNotUsed(initialized))
+{
+  this->UpdateHierarchy(propList, listLength);
+  this->NumberOfDrawnProps = static_cast<int>(this->Items.size());
+  this->NumberOfCulledProps = 0;
+  this->NumberOfOccludedProps = 0;
+  this->Candidates.clear();
+
+  // the occlusion is only known if a pass has tested the props since the last call, and
+  // it is ignored when the camera moves quickly since the hidden props may appear
+  bool steady = this->IsCameraSteady(ren);
+  bool useOcclusion = this->OcclusionCulling && this->OcclusionUpdated && steady;
+  this->OcclusionUpdated = false;
+
+  if (this->Nodes.empty())
+  {
+    return static_cast<double>(listLength);
+  }
+
+  vtkF3DPointCloudOctree::View view = vtkF3DPointCloudOctree::GetView(ren);
+  double minimumSize = this->Interactive ? this->MinimumScreenSize : 0.0;
+  auto isVisible = [&](const double bounds[6]) {
+    return view.IsInFrustum(bounds) &&
+      (minimumSize <= 0.0 ||
+        view.GetProjectedSize(bounds, ::GetDiagonal(bounds)) >= minimumSize);
+  };
+
+  // the props of the hidden nodes are culled without testing them
+  std::vector<bool> culled(listLength, false);
+  std::vector<int> stack = { 0 };
+  while (!stack.empty())
+  {
+    const Node& node = this->Nodes[stack.back()];
+    stack.pop_back();
+
+    bool leaf = node.Children[0] < 0;
+    if (!isVisible(node.Bounds))
+    {
+      for (int i = node.First; i < node.First + node.Count; i++)
+      {
+        culled[this->Items[i].Index] = true;
+      }
+    }
+    else if (leaf)
+    {
+      for (int i = node.First; i < node.First + node.Count; i++)
+      {
+        const Item& item = this->Items[i];
+        bool visible = isVisible(item.Bounds);
+        if (visible)
+        {
+          this->Candidates.push_back(i);
+          auto it = this->Occluded.find(item.Prop);
+          if (useOcclusion && it != this->Occluded.end() && it->second)
+          {
+            visible = false;
+            this->NumberOfOccludedProps++;
+          }
+        }
+        culled[item.Index] = !visible;
+      }
+    }
+    else
+    {
+      stack.push_back(node.Children[0]);
+      stack.push_back(node.Children[1]);
+    }
+  }
+
+  // keep the order of the remaining props
+  int count = 0;
+  for (int i = 0; i < listLength; i++)
+  {
+    if (!culled[i])
+    {
+      propList[count++] = propList[i];
+    }
+  }
+  this->NumberOfCulledProps = listLength - count;
+  this->NumberOfDrawnProps -= this->NumberOfCulledProps;
+  listLength = count;
+
+  return static_cast<double>(listLength);
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DCuller::UpdateHierarchy(vtkProp** propList, int listLength)
+{
+  bool changed = listLength != static_cast<int>(this->Props.size()) ||
+    !std::equal(propList, propList + listLength, this->Props.begin());
+  if (changed)
+  {
+    this->Occluded.clear();
+  }
+  for (size_t i = 0; i < this->Items.size() && !changed; i++)
+  {
+    changed = this->Items[i].Prop->GetRedrawMTime() > this->BuildTime;
+  }
+  if (!changed)
+  {
+    return;
+  }
+
+  this->Props.assign(propList, propList + listLength);
+  this->Items.clear();
+  this->Nodes.clear();
+  for (int i = 0; i < listLength; i++)
+  {
+    const double* bounds = propList[i]->GetBounds();
+    if (bounds && vtkMath::AreBoundsInitialized(bounds))
+    {
+      Item item;
+      item.Prop = propList[i];
+      item.Index = i;
+      std::copy(bounds, bounds + 6, item.Bounds);
+      for (int c = 0; c < 3; c++)
+      {
+        item.Center[c] = 0.5 * (bounds[2 * c] + bounds[2 * c + 1]);
+      }
+      this->Items.push_back(item);
+    }
+  }
+  if (!this->Items.empty())
+  {
+    this->BuildNode(0, static_cast<int>(this->Items.size()));
+  }
+
+  this->BuildTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkF3DCuller::BuildNode(int begin, int end)
+{
+  Node node;
+  std::copy(this->Items[begin].Bounds, this->Items[begin].Bounds + 6, node.Bounds);
+  for (int i = begin + 1; i < end; i++)
+  {
+    for (int c = 0; c < 3; c++)
+    {
+      node.Bounds[2 * c] = std::min(node.Bounds[2 * c], this->Items[i].Bounds[2 * c]);
+      node.Bounds[2 * c + 1] =
+        std::max(node.Bounds[2 * c + 1], this->Items[i].Bounds[2 * c + 1]);
+    }
+  }
+  node.First = begin;
+  node.Count = end - begin;
+  node.Children[0] = -1;
+  node.Children[1] = -1;
+
+  int index = static_cast<int>(this->Nodes.size());
+  this->Nodes.push_back(node);
+  if (end - begin <= ::LeafSize)
+  {
+    return index;
+  }
+
+  // split at the median of the centers along the longest axis of the node
+  int axis = 0;
+  for (int c = 1; c < 3; c++)
+  {
+    if (node.Bounds[2 * c + 1] - node.Bounds[2 * c] >
+      node.Bounds[2 * axis + 1] - node.Bounds[2 * axis])
+    {
+      axis = c;
+    }
+  }
+  int middle = (begin + end) / 2;
+  std::nth_element(this->Items.begin() + begin, this->Items.begin() + middle,
+    this->Items.begin() + end,
+    [axis](const Item& a, const Item& b) { return a.Center[axis] < b.Center[axis]; });
+
+  int left = this->BuildNode(begin, middle);
+  int right = this->BuildNode(middle, end);
+  this->Nodes[index].Children[0] = left;
+  this->Nodes[index].Children[1] = right;
+  return index;
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DCuller::IsCameraSteady(vtkRenderer* ren)
+{
+  vtkCamera* camera = ren->GetActiveCamera();
+  double position[3];
+  double direction[3];
+  camera->GetPosition(position);
+  camera->GetDirectionOfProjection(direction);
+
+  double maxMove =
+    this->Nodes.empty() ? 0.0 : ::MaxCameraMove * ::GetDiagonal(this->Nodes[0].Bounds);
+  bool steady =
+    vtkMath::Distance2BetweenPoints(position, this->LastCameraPosition) <= maxMove * maxMove &&
+    vtkMath::Dot(direction, this->LastCameraDirection) >=
+      std::cos(vtkMath::RadiansFromDegrees(::MaxCameraRotation));
+
+  std::copy(position, position + 3, this->LastCameraPosition);
+  std::copy(direction, direction + 3, this->LastCameraDirection);
+  return steady;
+}
+
+//----------------------------------------------------------------------------
+int vtkF3DCuller::GetNumberOfOcclusionCandidates() const
+{
+  return static_cast<int>(this->Candidates.size());
+}
+
+//----------------------------------------------------------------------------
+vtkProp* vtkF3DCuller::GetOcclusionCandidate(int index, double bounds[6]) const
+{
+  const Item& item = this->Items[this->Candidates[index]];
+  std::copy(item.Bounds, item.Bounds + 6, bounds);
+  return item.Prop;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DCuller::SetOccluded(vtkProp* prop, bool occluded)
+{
+  this->Occluded[prop] = occluded;
+  this->OcclusionUpdated = true;
+}
@@ -0,0 +1,161 @@
+/**
+ * @class   vtkF3DCuller
+ * @brief   Culler removing the props out of the view or too small on screen
+ *
+ * vtkF3DCuller keeps the bounds of the props in a bounding volume hierarchy, rebuilt only
+ * when the props or their bounds change, so that whole groups of parts outside the camera
+ * frustum are removed from the rendered props with a single test.
+ * While interacting, the props whose projected size is smaller than a number of pixels are
+ * also removed, which keeps the frame rate of scenes made of thousands of small parts.
+ * With occlusion culling, the props whose bounding box was hidden by the opaque geometry of
+ * a previous frame, as tested by vtkF3DOcclusionQueryPass, are removed as well, unless the
+ * camera moved too much since that frame.
+ * Props without bounds, like the 2D actors and the skybox, are always rendered.
+ *
+ * @sa
+ * vtkF3DOcclusionQueryPass vtkF3DPointCloudOctree
+ */
+
+#ifndef vtkF3DCuller_h
+#define vtkF3DCuller_h
+
+#include <vtkCuller.h>
+
+#include <unordered_map>
+#include <vector>
+
+class vtkF3DCuller : public vtkCuller
+{
+public:
+  static vtkF3DCuller* New();
+  vtkTypeMacro(vtkF3DCuller, vtkCuller);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /**
+   * Remove the props culled for the active camera of the renderer from the list
+   */
+  double Cull(vtkRenderer* ren, vtkProp** propList, int& listLength, int& initialized) override;
+
+  //@{
+  /**
+   * Set/Get the size in pixels under which the props are culled while interacting.
+   * Default is 0, which only culls the props out of the view.
+   */
+  vtkSetMacro(MinimumScreenSize, double);
+  vtkGetMacro(MinimumScreenSize, double);
+  //@}
+
+  //@{
+  /**
+   * Set/Get if the small props are culled
+   */
+  vtkSetMacro(Interactive, bool);
+  vtkGetMacro(Interactive, bool);
+  //@}
+
+  //@{
+  /**
+   * Set/Get if the props hidden in a previous frame are culled.
+   * Default is false.
+   */
+  vtkSetMacro(OcclusionCulling, bool);
+  vtkGetMacro(OcclusionCulling, bool);
+  vtkBooleanMacro(OcclusionCulling, bool);
+  //@}
+
+  //@{
+  /**
+   * Get the number of props with bounds drawn and culled by the last call to Cull,
+   * the culled props including the occluded ones
+   */
+  vtkGetMacro(NumberOfDrawnProps, int);
+  vtkGetMacro(NumberOfCulledProps, int);
+  vtkGetMacro(NumberOfOccludedProps, int);
+  //@}
+
+  /**
+   * Get the number of props in the view at the last call to Cull, occluded or not,
+   * whose visibility has to be tested for the next frames
+   */
+  int GetNumberOfOcclusionCandidates() const;
+
+  /**
+   * Get a prop in the view at the last call to Cull and its bounds
+   */
+  vtkProp* GetOcclusionCandidate(int index, double bounds[6]) const;
+
+  /**
+   * Set if the bounding box of a prop is hidden by the opaque geometry of a frame
+   */
+  void SetOccluded(vtkProp* prop, bool occluded);
+
+protected:
+  vtkF3DCuller() = default;
+  ~vtkF3DCuller() override = default;
+
+  /**
+   * Prop with bounds, and its index in the list of props
+   */
+  struct Item
+  {
+    vtkProp* Prop;
+    int Index;
+    double Bounds[6];
+    double Center[3];
+  };
+
+  /**
+   * Node of the hierarchy, with two children or a range of items
+   */
+  struct Node
+  {
+    double Bounds[6];
+    int First;
+    int Count;
+    int Children[2];
+  };
+
+  /**
+   * Rebuild the hierarchy if the props or their bounds have changed since the last build
+   */
+  void UpdateHierarchy(vtkProp** propList, int listLength);
+
+  /**
+   * Build the node of the items between begin and end and its children, return its index
+   */
+  int BuildNode(int begin, int end);
+
+  /**
+   * Return true if the camera is close enough to the one of the previous call
+   * to use the occlusion results, and store the current camera
+   */
+  bool IsCameraSteady(vtkRenderer* ren);
+
+  double MinimumScreenSize = 0.0;
+  bool Interactive = false;
+  bool OcclusionCulling = false;
+  int NumberOfDrawnProps = 0;
+  int NumberOfCulledProps = 0;
+  int NumberOfOccludedProps = 0;
+
+  std::vector<vtkProp*> Props;
+  std::vector<Item> Items;
+  std::vector<Node> Nodes;
+  vtkTimeStamp BuildTime;
+
+  // items in the view at the last call to Cull
+  std::vector<int> Candidates;
+
+  // occlusion of the props, and if it was set since the last call to Cull
+  std::unordered_map<vtkProp*, bool> Occluded;
+  bool OcclusionUpdated = false;
+
+  double LastCameraPosition[3] = { 0.0, 0.0, 0.0 };
+  double LastCameraDirection[3] = { 0.0, 0.0, 0.0 };
+
+private:
+  vtkF3DCuller(const vtkF3DCuller&) = delete;
+  void operator=(const vtkF3DCuller&) = delete;
+};
+
+#endif
@@ -0,0 +1,210 @@
+#include "vtkF3DDepthPrepass.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkOpenGLState.h>
+#include <vtkRenderState.h>
+#include <vtkRenderer.h>
+#include <vtkShaderProgram.h>
+#include <vtk_glew.h>
+
+vtkStandardNewMacro(vtkF3DDepthPrepass);
+
+namespace
+{
+// Marker replaced by the depth only branch once the fragment shader is complete
+const char* DepthOnlyMarker = "//F3D::DepthOnly::Impl";
+}
+
+//----------------------------------------------------------------------------
+vtkF3DDepthPrepass::~vtkF3DDepthPrepass() = default;
+
+//----------------------------------------------------------------------------
+void vtkF3DDepthPrepass::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "OverdrawThreshold: " << this->OverdrawThreshold << "\n";
+  os << indent << "Overdraw: " << this->Overdraw << "\n";
+  os << indent << "PrepassUsed: " << (this->PrepassUsed ? "true" : "false") << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DDepthPrepass::Render(const vtkRenderState* s)
+{
+  this->NumberOfRenderedProps = 0;
+  if (!this->DelegatePass)
+  {
+    return;
+  }
+
+  vtkRenderer* ren = s->GetRenderer();
+  vtkOpenGLRenderWindow* renWin = static_cast<vtkOpenGLRenderWindow*>(ren->GetRenderWindow());
+  vtkOpenGLState* ostate = renWin->GetState();
+
+  // the fragments of the first rendering are counted, with or without prepass the same
+  // fragments pass the depth test since the depth buffer is filled the same way
+  bool measure = this->CollectOverdraw();
+  if (measure)
+  {
+    int width, height, x, y;
+    ren->GetTiledSizeAndOrigin(&width, &height, &x, &y);
+    this->QueryPixels = static_cast<double>(width) * height;
+    if (this->Query == 0)
+    {
+      glGenQueries(1, &this->Query);
+    }
+    glBeginQuery(GL_SAMPLES_PASSED, this->Query);
+  }
+
+  // the pass is always added to the props so that their shaders do not change when the
+  // prepass starts or stops being used
+  this->PreRender(s);
+
+  if (this->PrepassUsed)
+  {
+    vtkOpenGLState::ScopedglColorMask colorSaver(ostate);
+    vtkOpenGLState::ScopedglDepthFunc depthFuncSaver(ostate);
+
+    // fill the depth buffer only
+    this->DepthOnly = true;
+    ostate->vtkglColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    this->DelegatePass->Render(s);
+    this->DepthOnly = false;
+    if (measure)
+    {
+      glEndQuery(GL_SAMPLES_PASSED);
+      this->QueryPending = true;
+    }
+
+    // shade the visible fragments only, the actors keep writing the same depths
+    ostate->vtkglColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    ostate->vtkglDepthFunc(GL_EQUAL);
+    this->DelegatePass->Render(s);
+  }
+  else
+  {
+    this->DelegatePass->Render(s);
+    if (measure)
+    {
+      glEndQuery(GL_SAMPLES_PASSED);
+      this->QueryPending = true;
+    }
+  }
+  this->NumberOfRenderedProps = this->DelegatePass->GetNumberOfRenderedProps();
+
+  this->PostRender(s);
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DDepthPrepass::CollectOverdraw()
+{
+  if (!this->QueryPending)
+  {
+    return true;
+  }
+
+  GLint available = 0;
+  glGetQueryObjectiv(this->Query, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available)
+  {
+    return false;
+  }
+
+  GLuint samples = 0;
+  glGetQueryObjectuiv(this->Query, GL_QUERY_RESULT, &samples);
+  this->QueryPending = false;
+  this->Overdraw = this->QueryPixels > 0.0 ? samples / this->QueryPixels : 0.0;
+
+  if (this->Overdraw >= this->OverdrawThreshold)
+  {
+    this->PrepassUsed = true;
+  }
+  else if (this->Overdraw < 0.75 * this->OverdrawThreshold)
+  {
+    this->PrepassUsed = false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DDepthPrepass::PreReplaceShaderValues(std::string& vtkNotUsed(vertexShader),
+  std::string& vtkNotUsed(geometryShader), std::string& fragmentShader,
+  vtkAbstractMapper* vtkNotUsed(mapper), vtkProp* vtkNotUsed(prop))
+{
+  vtkShaderProgram::Substitute(
+    fragmentShader, "//VTK::Output::Dec", "//VTK::Output::Dec\nuniform int f3dDepthOnly;\n");
+  vtkShaderProgram::Substitute(fragmentShader, "//VTK::Clip::Impl",
+    std::string("//VTK::Clip::Impl\n") + ::DepthOnlyMarker + "\n");
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DDepthPrepass::PostReplaceShaderValues(std::string& vtkNotUsed(vertexShader),
+  std::string& vtkNotUsed(geometryShader), std::string& fragmentShader,
+  vtkAbstractMapper* vtkNotUsed(mapper), vtkProp* vtkNotUsed(prop))
+{
+  size_t marker = fragmentShader.find(::DepthOnlyMarker);
+  if (marker == std::string::npos)
+  {
+    return true;
+  }
+
+  // the rest of the shader has to run when it changes the depth or the covered fragments
+  bool changesDepth = fragmentShader.find("discard", marker) != std::string::npos ||
+    fragmentShader.find("gl_FragDepth", marker) != std::string::npos;
+  std::string branch;
+  if (!changesDepth)
+  {
+    branch = "  if (f3dDepthOnly != 0)\n"
+             "  {\n"
+             "    return;\n"
+             "  }\n";
+  }
+  vtkShaderProgram::Substitute(fragmentShader, ::DepthOnlyMarker, branch);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DDepthPrepass::SetShaderParameters(vtkShaderProgram* program,
+  vtkAbstractMapper* vtkNotUsed(mapper), vtkProp* vtkNotUsed(prop),
+  vtkOpenGLVertexArrayObject* vtkNotUsed(VAO))
+{
+  if (program->IsUniformUsed("f3dDepthOnly"))
+  {
+    program->SetUniformi("f3dDepthOnly", this->DepthOnly ? 1 : 0);
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DDepthPrepass::ReleaseGraphicsResources(vtkWindow* w)
+{
+  if (this->Query != 0)
+  {
+    glDeleteQueries(1, &this->Query);
+    this->Query = 0;
+  }
+  this->QueryPending = false;
+
+  if (this->DelegatePass)
+  {
+    this->DelegatePass->ReleaseGraphicsResources(w);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DDepthPrepass::SetDelegatePass(vtkRenderPass* pass)
+{
+  if (this->DelegatePass != pass)
+  {
+    this->DelegatePass = pass;
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkRenderPass* vtkF3DDepthPrepass::GetDelegatePass()
+{
+  return this->DelegatePass;
+}
@@ -0,0 +1,110 @@
+/**
+ * @class   vtkF3DDepthPrepass
+ * @brief   Render the opaque geometry in a depth only pass before shading it
+ *
+ * vtkF3DDepthPrepass renders its delegate pass twice. The first time, the colors are not
+ * written and the fragment shaders return right after the clipping, so that only the depth
+ * buffer is filled. The second time, only the fragments whose depth is equal to the stored one
+ * pass the depth test, so that the physically based shading is computed once per pixel
+ * whatever the number of surfaces behind it.
+ * Both renderings use the same shader program, only an uniform changes between them, which
+ * guarantees that the depths are exactly the same and that no shader is compiled twice.
+ * The fragment shaders discarding fragments or writing their depth are fully run in both
+ * renderings.
+ *
+ * The overdraw, the number of fragments passing the depth test divided by the number of pixels
+ * of the viewport, is measured at each frame with an occlusion query whose result is read in the
+ * next frames without waiting for the GPU. The depth prepass is only used when the overdraw is
+ * higher than a threshold, the delegate pass being rendered once otherwise.
+ *
+ * @sa
+ * vtkOpaquePass
+ */
+
+#ifndef vtkF3DDepthPrepass_h
+#define vtkF3DDepthPrepass_h
+
+#include <vtkOpenGLRenderPass.h>
+#include <vtkSmartPointer.h>
+
+class vtkF3DDepthPrepass : public vtkOpenGLRenderPass
+{
+public:
+  static vtkF3DDepthPrepass* New();
+  vtkTypeMacro(vtkF3DDepthPrepass, vtkOpenGLRenderPass);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  void Render(const vtkRenderState* s) override;
+
+  void ReleaseGraphicsResources(vtkWindow* w) override;
+
+  /**
+   * Add the depth only branch to the fragment shaders
+   */
+  bool PreReplaceShaderValues(std::string& vertexShader, std::string& geometryShader,
+    std::string& fragmentShader, vtkAbstractMapper* mapper, vtkProp* prop) override;
+  bool PostReplaceShaderValues(std::string& vertexShader, std::string& geometryShader,
+    std::string& fragmentShader, vtkAbstractMapper* mapper, vtkProp* prop) override;
+
+  /**
+   * Select the branch of the fragment shaders used by the current rendering
+   */
+  bool SetShaderParameters(vtkShaderProgram* program, vtkAbstractMapper* mapper, vtkProp* prop,
+    vtkOpenGLVertexArrayObject* VAO = nullptr) override;
+
+  //@{
+  /**
+   * Set/Get the pass rendering the opaque geometry
+   */
+  void SetDelegatePass(vtkRenderPass* pass);
+  vtkRenderPass* GetDelegatePass();
+  //@}
+
+  //@{
+  /**
+   * Set/Get the overdraw above which the depth prepass is used.
+   * It stops being used when the overdraw falls under three quarters of this value,
+   * so that it is not toggled at each frame. 0 uses it at every frame.
+   * Default is 2.
+   */
+  vtkSetMacro(OverdrawThreshold, double);
+  vtkGetMacro(OverdrawThreshold, double);
+  //@}
+
+  /**
+   * Get the last measured overdraw, 0 if no measure is available yet
+   */
+  vtkGetMacro(Overdraw, double);
+
+  /**
+   * Get whether the depth prepass was used by the last rendering
+   */
+  vtkGetMacro(PrepassUsed, bool);
+
+protected:
+  vtkF3DDepthPrepass() = default;
+  ~vtkF3DDepthPrepass() override;
+
+  /**
+   * Read the result of the pending overdraw query if available, and update the use
+   * of the depth prepass. Return true if a new query can be issued.
+   */
+  bool CollectOverdraw();
+
+  vtkSmartPointer<vtkRenderPass> DelegatePass;
+
+  double OverdrawThreshold = 2.0;
+  double Overdraw = 0.0;
+  bool PrepassUsed = false;
+  bool DepthOnly = false;
+
+  unsigned int Query = 0;
+  bool QueryPending = false;
+  double QueryPixels = 0.0;
+
+private:
+  vtkF3DDepthPrepass(const vtkF3DDepthPrepass&) = delete;
+  void operator=(const vtkF3DDepthPrepass&) = delete;
+};
+
+#endif
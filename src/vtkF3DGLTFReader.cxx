@@ -0,0 +1,12 @@
+#include "vtkF3DGLTFReader.h"
+
+#include <vtkGLTFDocumentLoader.h>
+#include <vtkObjectFactory.h>
+
+vtkStandardNewMacro(vtkF3DGLTFReader);
+
+//----------------------------------------------------------------------------
+vtkGLTFDocumentLoader* vtkF3DGLTFReader::GetLoader()
+{
+  return this->Loader;
+}
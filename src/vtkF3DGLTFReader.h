@@ -0,0 +1,40 @@
+/**
+ * @class   vtkF3DGLTFReader
+ * @brief   glTF reader giving access to its document loader
+ *
+ * vtkF3DGLTFReader is a vtkGLTFReader exposing the loader it uses, so that the model it has
+ * already parsed can drive the GPU deformation of its output without reading the file again.
+ *
+ * @sa
+ * vtkGLTFReader vtkF3DGenericImporter
+ */
+
+#ifndef vtkF3DGLTFReader_h
+#define vtkF3DGLTFReader_h
+
+#include <vtkGLTFReader.h>
+
+class vtkGLTFDocumentLoader;
+
+class vtkF3DGLTFReader : public vtkGLTFReader
+{
+public:
+  static vtkF3DGLTFReader* New();
+  vtkTypeMacro(vtkF3DGLTFReader, vtkGLTFReader);
+
+  /**
+   * Get the document loader of the reader. Its model contains the metadata once the
+   * information has been requested, and the buffers once the data has been requested.
+   */
+  vtkGLTFDocumentLoader* GetLoader();
+
+protected:
+  vtkF3DGLTFReader() = default;
+  ~vtkF3DGLTFReader() override = default;
+
+private:
+  vtkF3DGLTFReader(const vtkF3DGLTFReader&) = delete;
+  void operator=(const vtkF3DGLTFReader&) = delete;
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "vtkF3DGPUProfiler.h"
+
+#include <vtkObjectFactory.h>
+#include <vtk_glew.h>
+
+vtkStandardNewMacro(vtkF3DGPUProfiler);
+
+//----------------------------------------------------------------------------
+void vtkF3DGPUProfiler::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "FrameTime: " << this->FrameTime << "\n";
+  for (const auto& section : this->SectionTimes)
+  {
+    os << indent << section.first << ": " << section.second << "\n";
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DGPUProfiler::BeginFrame()
+{
+  this->Collect();
+
+  QuerySet& querySet = this->QuerySets[this->NextQuerySet];
+  if (querySet.Pending)
+  {
+    // the GPU is more than NumberOfQuerySets frames late, do not wait for it
+    this->CurrentQuerySet = nullptr;
+    return;
+  }
+
+  this->NextQuerySet = (this->NextQuerySet + 1) % NumberOfQuerySets;
+  this->CurrentQuerySet = &querySet;
+  querySet.Count = 0;
+
+  this->Mark("Start");
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DGPUProfiler::Mark(const std::string& section)
+{
+  QuerySet* querySet = this->CurrentQuerySet;
+  if (!querySet)
+  {
+    return;
+  }
+
+  if (querySet->Count == querySet->Queries.size())
+  {
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    querySet->Queries.push_back(query);
+    querySet->Sections.emplace_back();
+  }
+
+  glQueryCounter(querySet->Queries[querySet->Count], GL_TIMESTAMP);
+  querySet->Sections[querySet->Count] = section;
+  querySet->Count++;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DGPUProfiler::EndFrame()
+{
+  if (!this->CurrentQuerySet)
+  {
+    return;
+  }
+
+  this->Mark("Other");
+  this->CurrentQuerySet->Pending = true;
+  this->CurrentQuerySet = nullptr;
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DGPUProfiler::IsMeasuring()
+{
+  return this->CurrentQuerySet != nullptr;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DGPUProfiler::Collect()
+{
+  // from the oldest to the newest set, so the results are the ones of the last available frame
+  for (int i = 0; i < NumberOfQuerySets; i++)
+  {
+    QuerySet& querySet = this->QuerySets[(this->NextQuerySet + i) % NumberOfQuerySets];
+    if (!querySet.Pending)
+    {
+      continue;
+    }
+
+    // the queries complete in order, so the last one is enough to know if all are available
+    GLint available = 0;
+    glGetQueryObjectiv(querySet.Queries[querySet.Count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+      break;
+    }
+
+    std::vector<GLuint64> timestamps(querySet.Count);
+    for (size_t j = 0; j < querySet.Count; j++)
+    {
+      glGetQueryObjectui64v(querySet.Queries[j], GL_QUERY_RESULT, &timestamps[j]);
+    }
+
+    this->SectionTimes.clear();
+    for (size_t j = 1; j < querySet.Count; j++)
+    {
+      this->SectionTimes.emplace_back(
+        querySet.Sections[j], (timestamps[j] - timestamps[j - 1]) * 1e-6);
+    }
+    this->FrameTime = (timestamps[querySet.Count - 1] - timestamps[0]) * 1e-6;
+    querySet.Pending = false;
+  }
+}
+
+//----------------------------------------------------------------------------
+double vtkF3DGPUProfiler::GetFrameTime()
+{
+  return this->FrameTime;
+}
+
+//----------------------------------------------------------------------------
+const std::vector<std::pair<std::string, double> >& vtkF3DGPUProfiler::GetSectionTimes()
+{
+  return this->SectionTimes;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DGPUProfiler::ReleaseGraphicsResources()
+{
+  for (QuerySet& querySet : this->QuerySets)
+  {
+    if (!querySet.Queries.empty())
+    {
+      glDeleteQueries(static_cast<GLsizei>(querySet.Queries.size()), querySet.Queries.data());
+    }
+    querySet.Queries.clear();
+    querySet.Sections.clear();
+    querySet.Count = 0;
+    querySet.Pending = false;
+  }
+  this->CurrentQuerySet = nullptr;
+  this->NextQuerySet = 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * @class   vtkF3DGPUProfiler
+ * @brief   Measure the GPU time of the sections of a frame without stalling the pipeline
+ *
+ * vtkF3DGPUProfiler records an OpenGL timestamp query at the beginning of a frame and at the
+ * end of each section of the frame. The queries are read back a few frames later, once they
+ * are available, so the CPU never waits for the GPU. Several sets of queries are used in
+ * turn; if none is available, the frame is not measured.
+ *
+ * @sa
+ * vtkF3DTimestampPass
+ */
+
+#ifndef vtkF3DGPUProfiler_h
+#define vtkF3DGPUProfiler_h
+
+#include <vtkObject.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class vtkF3DGPUProfiler : public vtkObject
+{
+public:
+  static vtkF3DGPUProfiler* New();
+  vtkTypeMacro(vtkF3DGPUProfiler, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /**
+   * Start measuring a frame, and collect the results of the previous frames that are available.
+   * An OpenGL context must be current.
+   */
+  void BeginFrame();
+
+  /**
+   * Record the end of a section of the current frame, the section starting at the end of the
+   * previous one. Does nothing if the frame is not measured.
+   */
+  void Mark(const std::string& section);
+
+  /**
+   * Stop measuring the current frame, the time since the last section is recorded as "Other"
+   */
+  void EndFrame();
+
+  /**
+   * Return true between BeginFrame and EndFrame if the frame is measured
+   */
+  bool IsMeasuring();
+
+  /**
+   * Get the GPU time of the last measured frame in milliseconds, or 0 if not available yet
+   */
+  double GetFrameTime();
+
+  /**
+   * Get the GPU time of each section of the last measured frame in milliseconds
+   */
+  const std::vector<std::pair<std::string, double> >& GetSectionTimes();
+
+  /**
+   * Release the queries, an OpenGL context must be current
+   */
+  void ReleaseGraphicsResources();
+
+protected:
+  vtkF3DGPUProfiler() = default;
+  ~vtkF3DGPUProfiler() override = default;
+
+  void Collect();
+
+  struct QuerySet
+  {
+    std::vector<unsigned int> Queries;
+    std::vector<std::string> Sections;
+    size_t Count = 0;
+    bool Pending = false;
+  };
+
+  static constexpr int NumberOfQuerySets = 3;
+  QuerySet QuerySets[NumberOfQuerySets];
+  int NextQuerySet = 0;
+  QuerySet* CurrentQuerySet = nullptr;
+
+  double FrameTime = 0.0;
+  std::vector<std::pair<std::string, double> > SectionTimes;
+
+private:
+  vtkF3DGPUProfiler(const vtkF3DGPUProfiler&) = delete;
+  void operator=(const vtkF3DGPUProfiler&) = delete;
+};
+
+#endif
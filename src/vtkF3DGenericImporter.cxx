@@ -11,12 +11,15 @@
 #include <vtkDataSetSurfaceFilter.h>
 #include <vtkDoubleArray.h>
 #include <vtkEventForwarderCommand.h>
+#include <vtkGLTFDocumentLoader.h>
 #include <vtkImageData.h>
 #include <vtkImageReader2.h>
 #include <vtkImageReader2Factory.h>
 #include <vtkImageToPoints.h>
 #include <vtkInformation.h>
 #include <vtkLightKit.h>
+#include <vtkMaskPoints.h>
+#include <vtkMatrix4x4.h>
 #include <vtkMultiBlockDataSet.h>
 #include <vtkObjectFactory.h>
 #include <vtkPiecewiseFunction.h>
@@ -24,23 +27,84 @@
 #include <vtkPointGaussianMapper.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
+#include <vtkQuadricClustering.h>
 #include <vtkRectilinearGrid.h>
 #include <vtkRectilinearGridToPointSet.h>
 #include <vtkRenderer.h>
 #include <vtkScalarBarActor.h>
 #include <vtkScalarsToColors.h>
+#include <vtkShaderProperty.h>
 #include <vtkSmartPointer.h>
 #include <vtkSmartVolumeMapper.h>
+#include <vtkStaticPointLocator.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkTexture.h>
+#include <vtkUniforms.h>
 #include <vtkVertexGlyphFilter.h>
 #include <vtkVolumeProperty.h>
 #include <vtksys/SystemTools.hxx>
 
+#include "vtkF3DGLTFReader.h"
 #include "vtkF3DPostProcessFilter.h"
 
+#include <algorithm>
+
 vtkStandardNewMacro(vtkF3DGenericImporter);
 
+namespace
+{
+// Number of divisions of the vertex clustering grid, along the longest axis
+constexpr int ProxyDivisions = 384;
+
+//----------------------------------------------------------------------------
+// Run the proxy filter and transfer the point data of the closest input points,
+// since vertex clustering does not keep the point data.
+vtkSmartPointer<vtkPolyData> ComputeProxy(vtkAlgorithm* filter, vtkPolyData* input)
+{
+  filter->Update();
+  if (filter->GetAbortExecute())
+  {
+    return nullptr;
+  }
+
+  vtkSmartPointer<vtkPolyData> proxy = vtkPolyData::SafeDownCast(filter->GetOutputDataObject(0));
+  vtkPointData* inPD = input->GetPointData();
+  vtkPointData* outPD = proxy->GetPointData();
+  if (vtkMaskPoints::SafeDownCast(filter) || inPD->GetNumberOfArrays() == 0)
+  {
+    return proxy;
+  }
+
+  vtkNew<vtkStaticPointLocator> locator;
+  locator->SetDataSet(input);
+  locator->BuildLocator();
+
+  vtkIdType nbPoints = proxy->GetNumberOfPoints();
+  outPD->CopyAllocate(inPD, nbPoints);
+  for (vtkIdType i = 0; i < nbPoints; i++)
+  {
+    if (i % 65536 == 0 && filter->GetAbortExecute())
+    {
+      return nullptr;
+    }
+    outPD->CopyData(inPD, locator->FindClosestPoint(proxy->GetPoint(i)), i);
+  }
+  return proxy;
+}
+}
+
+//----------------------------------------------------------------------------
+vtkF3DGenericImporter::~vtkF3DGenericImporter()
+{
+  if (this->ProxyThread.joinable())
+  {
+    // the thread must not outlive the importer, it stops at the end of the filter execution
+    // or at the next check of the abort flag while transferring the point data
+    this->ProxyFilter->AbortExecuteOn();
+    this->ProxyThread.join();
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkF3DGenericImporter::UpdateTemporalInformation()
 {
@@ -133,6 +197,10 @@ void vtkF3DGenericImporter::ImportActors(vtkRenderer* ren)
   forwarder->SetTarget(this);
   this->Reader->AddObserver(vtkCommand::ProgressEvent, forwarder);
 
+  // skinning and morphing are computed by the mapper when possible,
+  // this has to be known before the reader deforms the geometry
+  bool gpuDeformation = !this->Options->NoRender && this->InitializeGPUDeformation();
+
   this->PostPro->SetInputConnection(this->Reader->GetOutputPort());
   bool ret = this->PostPro->GetExecutive()->Update();
 
@@ -161,6 +229,7 @@ void vtkF3DGenericImporter::ImportActors(vtkRenderer* ren)
   // Configure volume mapper
   this->VolumeMapper->SetInputConnection(this->PostPro->GetOutputPort(2));
   this->VolumeMapper->SetRequestedRenderModeToGPU();
+  this->VolumeMapper->SetMemoryBudget(this->Options->VolumeBudget);
 
   // Configure polydata mapper
   this->PolyDataMapper->InterpolateScalarsBeforeMappingOn();
@@ -179,6 +248,7 @@ void vtkF3DGenericImporter::ImportActors(vtkRenderer* ren)
   this->PointGaussianMapper->SetInputConnection(this->PostPro->GetOutputPort(1));
   this->PointGaussianMapper->SetScaleFactor(pointSize);
   this->PointGaussianMapper->EmissiveOff();
+  this->PointGaussianMapper->SetPointBudget(this->Options->PointBudget);
   this->PointGaussianMapper->SetSplatShaderCode(
     "//VTK::Color::Impl\n"
     "float dist = dot(offsetVCVSOutput.xy, offsetVCVSOutput.xy);\n"
@@ -285,13 +355,186 @@ void vtkF3DGenericImporter::ImportActors(vtkRenderer* ren)
   this->GeometryActor->GetProperty()->SetNormalTexture(this->GetTexture(this->Options->NormalTex));
   this->GeometryActor->GetProperty()->SetNormalScale(this->Options->NormalScale);
 
+  if (gpuDeformation)
+  {
+    this->UpdateGPUDeformation(this->TimeSteps && this->NbTimeSteps > 0 ? this->TimeSteps[0] : 0);
+    if (print)
+    {
+      F3DLog::Print(F3DLog::Severity::Info, "Using GPU skinning and morphing");
+    }
+  }
+
+  // static surfaces too big to be rendered interactively use a proxy while interacting
+  if (!this->DeformationLoader && this->GetNumberOfAnimations() == 0)
+  {
+    this->InitializeProxy(surface);
+  }
+
   // add props
   ren->AddActor2D(this->ScalarBarActor);
   ren->AddActor(this->GeometryActor);
   ren->AddActor(this->PointSpritesActor);
+  ren->AddActor(this->ProxyActor);
   ren->AddVolume(this->VolumeProp);
 }
 
+//----------------------------------------------------------------------------
+void vtkF3DGenericImporter::InitializeProxy(vtkPolyData* surface)
+{
+  // the proxy is shown by the renderer while interacting
+  this->ProxyActor->SetMapper(this->ProxyMapper);
+  this->ProxyActor->SetProperty(this->GeometryActor->GetProperty());
+  this->ProxyActor->VisibilityOff();
+  this->ProxyMapper->InterpolateScalarsBeforeMappingOn();
+
+  vtkIdType nbCells = surface->GetNumberOfPolys() + surface->GetNumberOfStrips();
+  bool isPointCloud = nbCells == 0 && surface->GetNumberOfLines() == 0;
+  vtkIdType size = isPointCloud ? surface->GetNumberOfPoints() : nbCells;
+  vtkIdType threshold = this->Options->ProxyThreshold;
+  if (threshold <= 0 || size < threshold)
+  {
+    return;
+  }
+
+  if (isPointCloud)
+  {
+    vtkNew<vtkMaskPoints> mask;
+    mask->SetOnRatio(static_cast<int>(size / std::max<vtkIdType>(threshold / 2, 1) + 1));
+    mask->RandomModeOn();
+    mask->GenerateVerticesOn();
+    mask->SingleVertexPerCellOn();
+    this->ProxyFilter = mask;
+  }
+  else
+  {
+    vtkNew<vtkQuadricClustering> clustering;
+    clustering->SetNumberOfDivisions(::ProxyDivisions, ::ProxyDivisions, ::ProxyDivisions);
+    clustering->AutoAdjustNumberOfDivisionsOn();
+    clustering->CopyCellDataOn();
+    this->ProxyFilter = clustering;
+  }
+
+  // the thread works on its own deep copy of the surface, since the render thread may modify
+  // the arrays and cells of the surface while building its buffers
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->DeepCopy(surface);
+  this->ProxyFilter->SetInputDataObject(input);
+
+  if (this->Options->Verbose)
+  {
+    F3DLog::Print(F3DLog::Severity::Info, "Computing an interactive proxy in the background");
+  }
+
+  vtkSmartPointer<vtkAlgorithm> filter = this->ProxyFilter;
+  std::packaged_task<vtkSmartPointer<vtkPolyData>()> task(
+    [filter, input]() { return ::ComputeProxy(filter, input); });
+  this->ProxyGeometry = task.get_future().share();
+  this->ProxyThread = std::thread(std::move(task));
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DGenericImporter::InitializeGPUDeformation()
+{
+  this->DeformationLoader = nullptr;
+  this->DeformedNode = -1;
+
+#if VTK_VERSION_NUMBER >= VTK_VERSION_CHECK(9, 0, 20210429)
+  // raytracing does not support custom shaders, and the point sprites use the reader output
+  vtkF3DGLTFReader* reader = vtkF3DGLTFReader::SafeDownCast(this->Reader->GetInternalReader());
+  if (this->Options->Raytracing || this->Options->PointSprites || !reader)
+  {
+    return false;
+  }
+
+  // the metadata of the model has been loaded when requesting the information
+  vtkGLTFDocumentLoader* loader = reader->GetLoader();
+  std::shared_ptr<vtkGLTFDocumentLoader::Model> model =
+    loader ? loader->GetInternalModel() : nullptr;
+  if (!model || model->Animations.empty())
+  {
+    return false;
+  }
+
+  int meshNode = -1;
+  for (size_t i = 0; i < model->Nodes.size(); i++)
+  {
+    if (model->Nodes[i].Mesh >= 0)
+    {
+      if (meshNode >= 0)
+      {
+        return false;
+      }
+      meshNode = static_cast<int>(i);
+    }
+  }
+  if (meshNode < 0)
+  {
+    return false;
+  }
+
+  // the reader outputs the bind pose with the joints, weights and morph targets arrays,
+  // which go through the post processing filter to the mapper
+  reader->ApplyDeformationsToGeometryOff();
+
+  this->DeformationLoader = loader;
+  this->DeformedNode = meshNode;
+  return true;
+#else
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DGenericImporter::UpdateGPUDeformation(double timestep)
+{
+#if VTK_VERSION_NUMBER >= VTK_VERSION_CHECK(9, 0, 20210429)
+  std::shared_ptr<vtkGLTFDocumentLoader::Model> model = this->DeformationLoader->GetInternalModel();
+
+  // the reader enables all the animations
+  for (size_t i = 0; i < model->Animations.size(); i++)
+  {
+    this->DeformationLoader->ApplyAnimation(static_cast<float>(timestep), static_cast<int>(i));
+  }
+  this->DeformationLoader->BuildGlobalTransforms();
+
+  vtkGLTFDocumentLoader::Node& node = model->Nodes[this->DeformedNode];
+  this->GeometryActor->SetUserMatrix(node.GlobalTransform);
+
+  vtkUniforms* uniforms = this->GeometryActor->GetShaderProperty()->GetVertexCustomUniforms();
+  if (node.Skin >= 0)
+  {
+    std::vector<vtkSmartPointer<vtkMatrix4x4> > jointMatrices;
+    vtkGLTFDocumentLoader::ComputeJointMatrices(
+      *model, model->Skins[node.Skin], node, jointMatrices);
+
+    // column-major, as expected by OpenGL
+    std::vector<float> palette;
+    palette.reserve(16 * jointMatrices.size());
+    for (const auto& mat : jointMatrices)
+    {
+      for (int col = 0; col < 4; col++)
+      {
+        for (int row = 0; row < 4; row++)
+        {
+          palette.push_back(static_cast<float>(mat->GetElement(row, col)));
+        }
+      }
+    }
+    uniforms->SetUniformMatrix4x4v(
+      "jointMatrices", static_cast<int>(jointMatrices.size()), palette.data());
+  }
+
+  std::vector<float>& weights =
+    node.Weights.empty() ? model->Meshes[node.Mesh].Weights : node.Weights;
+  if (!weights.empty())
+  {
+    uniforms->SetUniform1fv("morphWeights", static_cast<int>(weights.size()), weights.data());
+  }
+#else
+  (void)timestep;
+#endif
+}
+
 //----------------------------------------------------------------------------
 // TODO : add this function in a utils file for rendering in VTK directly
 vtkSmartPointer<vtkTexture> vtkF3DGenericImporter::GetTexture(
@@ -416,5 +659,11 @@ std::string vtkF3DGenericImporter::GetDataObjectDescription(vtkDataObject* objec
 //----------------------------------------------------------------------------
 void vtkF3DGenericImporter::UpdateTimeStep(double timestep)
 {
+  // the reader output stays in the bind pose when the mapper deforms it
+  if (this->DeformationLoader)
+  {
+    this->UpdateGPUDeformation(timestep);
+    return;
+  }
   this->PostPro->UpdateTimeStep(timestep);
 }
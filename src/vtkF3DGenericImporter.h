@@ -9,12 +9,19 @@
 #include "Config.h"
 
 #include "vtkF3DMetaReader.h"
+#include "vtkF3DPointCloudLODMapper.h"
 #include "vtkF3DPostProcessFilter.h"
+#include "vtkF3DVolumeLODMapper.h"
 
 #include <vtkImporter.h>
+#include <vtkPolyData.h>
 #include <vtkVersion.h>
 
+#include <future>
+#include <thread>
+
 class vtkActor;
+class vtkGLTFDocumentLoader;
 class vtkVolume;
 class vtkPolyDataMapper;
 class vtkMultiBlockDataSet;
@@ -68,6 +75,7 @@ public:
   vtkGetSmartPointerMacro(ScalarBarActor, vtkScalarBarActor);
   vtkGetSmartPointerMacro(GeometryActor, vtkActor);
   vtkGetSmartPointerMacro(PointSpritesActor, vtkActor);
+  vtkGetSmartPointerMacro(ProxyActor, vtkActor);
   vtkGetSmartPointerMacro(VolumeProp, vtkVolume);
   //@}
 
@@ -85,6 +93,10 @@ public:
    * Access to specific flags
    */
   vtkGetMacro(ArrayIndexForColoring, int);
+  const std::shared_future<vtkSmartPointer<vtkPolyData> >& GetProxyGeometry()
+  {
+    return this->ProxyGeometry;
+  }
   vtkGetObjectMacro(PointDataForColoring, vtkDataSetAttributes);
   vtkGetObjectMacro(CellDataForColoring, vtkDataSetAttributes);
   //@}
@@ -128,7 +140,7 @@ public:
 
 protected:
   vtkF3DGenericImporter() = default;
-  ~vtkF3DGenericImporter() override = default;
+  ~vtkF3DGenericImporter() override;
 
   void ImportActors(vtkRenderer*) override;
   void ImportLights(vtkRenderer*) override;
@@ -138,6 +150,30 @@ protected:
 
   void UpdateTemporalInformation();
 
+  /**
+   * Try to deform the geometry on the GPU instead of letting the reader deform it on the CPU
+   * for every time step. It must be called before the reader is updated, which then outputs
+   * the bind pose geometry once, and the skinning and morphing are driven by the actor custom
+   * uniforms computed from the model of the reader.
+   * Only glTF files with a single mesh node are supported, since the reader output is
+   * appended into a single mapper.
+   * Return true if the GPU deformation is used.
+   */
+  bool InitializeGPUDeformation();
+
+  /**
+   * Update the actor transform and custom uniforms for the given time step.
+   * The reader must have been updated.
+   */
+  void UpdateGPUDeformation(double timestep);
+
+  /**
+   * Start computing a simplified version of the surface in a background thread when it is
+   * too big to be rendered interactively. Meshes are decimated using vertex clustering
+   * and point clouds are subsampled.
+   */
+  void InitializeProxy(vtkPolyData* surface);
+
   vtkNew<vtkF3DMetaReader> Reader;
 
   const F3DOptions* Options = nullptr;
@@ -146,8 +182,8 @@ protected:
   vtkNew<vtkActor> PointSpritesActor;
   vtkNew<vtkVolume> VolumeProp;
   vtkNew<vtkPolyDataMapper> PolyDataMapper;
-  vtkNew<vtkPointGaussianMapper> PointGaussianMapper;
-  vtkNew<vtkSmartVolumeMapper> VolumeMapper;
+  vtkNew<vtkF3DPointCloudLODMapper> PointGaussianMapper;
+  vtkNew<vtkF3DVolumeLODMapper> VolumeMapper;
   std::string OutputDescription;
 
   vtkDataSetAttributes* PointDataForColoring = nullptr;
@@ -161,6 +197,15 @@ protected:
   double* TimeRange = nullptr;
   vtkNew<vtkF3DPostProcessFilter> PostPro;
 
+  vtkNew<vtkActor> ProxyActor;
+  vtkNew<vtkPolyDataMapper> ProxyMapper;
+  vtkSmartPointer<vtkAlgorithm> ProxyFilter;
+  std::shared_future<vtkSmartPointer<vtkPolyData> > ProxyGeometry;
+  std::thread ProxyThread;
+
+  vtkSmartPointer<vtkGLTFDocumentLoader> DeformationLoader;
+  int DeformedNode = -1;
+
 private:
   vtkF3DGenericImporter(const vtkF3DGenericImporter&) = delete;
   void operator=(const vtkF3DGenericImporter&) = delete;
@@ -0,0 +1,352 @@
+#include "vtkF3DHDRICache.h"
+
+#include "F3DLog.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkImageReader2.h>
+#include <vtkImageReader2Factory.h>
+#include <vtkImageResize.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPBRIrradianceTexture.h>
+#include <vtkPBRLUTTexture.h>
+#include <vtkPBRPrefilterTexture.h>
+#include <vtkPointData.h>
+#include <vtkTexture.h>
+#include <vtkXMLImageDataReader.h>
+#include <vtkXMLImageDataWriter.h>
+#include <vtksys/FStream.hxx>
+#include <vtksys/MD5.h>
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+vtkStandardNewMacro(vtkF3DHDRICache);
+
+namespace
+{
+std::string ComputeFileMD5(const std::string& fileName)
+{
+  vtksys::ifstream file(fileName.c_str(), std::ios::binary);
+  if (!file.is_open())
+  {
+    return std::string();
+  }
+
+  vtksysMD5* md5 = vtksysMD5_New();
+  vtksysMD5_Initialize(md5);
+  std::vector<char> buffer(1 << 16);
+  while (file)
+  {
+    file.read(buffer.data(), buffer.size());
+    vtksysMD5_Append(md5, reinterpret_cast<const unsigned char*>(buffer.data()),
+      static_cast<int>(file.gcount()));
+  }
+  char hash[32];
+  vtksysMD5_FinalizeHex(md5, hash);
+  vtksysMD5_Delete(md5);
+  return std::string(hash, 32);
+}
+
+//----------------------------------------------------------------------------
+std::vector<double> GaussianKernel(double sigma, int radius)
+{
+  std::vector<double> kernel(2 * radius + 1);
+  double sum = 0.0;
+  for (int k = -radius; k <= radius; k++)
+  {
+    kernel[k + radius] = std::exp(-0.5 * k * k / (sigma * sigma));
+    sum += kernel[k + radius];
+  }
+  for (double& weight : kernel)
+  {
+    weight /= sum;
+  }
+  return kernel;
+}
+
+//----------------------------------------------------------------------------
+// Separable gaussian blur of an equirectangular image, sigma being the deviation in pixels
+// at the equator. The rows wrap around the seam of the image and their deviation is scaled
+// by 1 / cos(latitude) so that the kernel covers about the same angle in every direction.
+// Near the poles, where a row is a tiny circle, it is clamped to average the whole row.
+// The columns are clamped at the poles.
+template <typename T>
+void BlurEquirectangular(
+  const T* input, T* output, int width, int height, int nbComponents, double sigma)
+{
+  std::vector<double> rows(static_cast<size_t>(width) * height * nbComponents);
+  for (int y = 0; y < height; y++)
+  {
+    double latitude = vtkMath::Pi() * ((y + 0.5) / height - 0.5);
+    double rowSigma = std::min(sigma / std::max(std::cos(latitude), 1e-3), width / 6.0);
+    int radius = static_cast<int>(std::ceil(3.0 * rowSigma));
+    std::vector<double> kernel = ::GaussianKernel(rowSigma, radius);
+
+    const T* inRow = input + static_cast<size_t>(y) * width * nbComponents;
+    double* outRow = rows.data() + static_cast<size_t>(y) * width * nbComponents;
+    for (int x = 0; x < width; x++)
+    {
+      for (int c = 0; c < nbComponents; c++)
+      {
+        double sum = 0.0;
+        for (int k = -radius; k <= radius; k++)
+        {
+          int xk = ((x + k) % width + width) % width;
+          sum += kernel[k + radius] * inRow[xk * nbComponents + c];
+        }
+        outRow[x * nbComponents + c] = sum;
+      }
+    }
+  }
+
+  int radius = static_cast<int>(std::ceil(3.0 * sigma));
+  std::vector<double> kernel = ::GaussianKernel(sigma, radius);
+  size_t rowSize = static_cast<size_t>(width) * nbComponents;
+  for (int y = 0; y < height; y++)
+  {
+    for (size_t i = 0; i < rowSize; i++)
+    {
+      double sum = 0.0;
+      for (int k = -radius; k <= radius; k++)
+      {
+        int yk = std::min(std::max(y + k, 0), height - 1);
+        sum += kernel[k + radius] * rows[yk * rowSize + i];
+      }
+      output[y * rowSize + i] = static_cast<T>(std::is_integral<T>::value ? sum + 0.5 : sum);
+    }
+  }
+}
+}
+
+//----------------------------------------------------------------------------
+vtkF3DHDRICache::vtkF3DHDRICache() = default;
+
+//----------------------------------------------------------------------------
+vtkF3DHDRICache::~vtkF3DHDRICache() = default;
+
+//----------------------------------------------------------------------------
+void vtkF3DHDRICache::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "FileName: " << this->FileName << "\n";
+  os << indent << "Hash: " << this->Hash << "\n";
+  os << indent << "Directory: " << this->Directory << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkTexture* vtkF3DHDRICache::GetTexture(const std::string& fileName)
+{
+  long int modifiedTime = vtksys::SystemTools::ModifiedTime(fileName);
+  if (this->Texture && fileName == this->FileName && modifiedTime == this->FileModifiedTime)
+  {
+    return this->Texture;
+  }
+
+  this->FileName = fileName;
+  this->FileModifiedTime = modifiedTime;
+  this->Hash = this->Directory.empty() ? std::string() : ComputeFileMD5(fileName);
+  this->Texture = nullptr;
+  this->BlurredTexture = nullptr;
+  this->EnvironmentTexture = nullptr;
+  this->Modified();
+
+  vtkSmartPointer<vtkImageData> image = this->LoadImage("");
+  if (!image)
+  {
+    auto reader = vtkSmartPointer<vtkImageReader2>::Take(
+      vtkImageReader2Factory::CreateImageReader2(fileName.c_str()));
+    if (!reader)
+    {
+      return nullptr;
+    }
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+
+    image = reader->GetOutput();
+    if (!image || !image->GetPointData()->GetScalars())
+    {
+      return nullptr;
+    }
+    this->SaveImage(image, "");
+  }
+
+  this->Texture = this->CreateTexture(image);
+  return this->Texture;
+}
+
+//----------------------------------------------------------------------------
+vtkTexture* vtkF3DHDRICache::GetBlurredTexture()
+{
+  if (this->BlurredTexture || !this->Texture)
+  {
+    return this->BlurredTexture;
+  }
+
+  vtkSmartPointer<vtkImageData> blurred = this->LoadImage("_blurred");
+  if (!blurred)
+  {
+    vtkImageData* image = vtkImageData::SafeDownCast(this->Texture->GetInputDataObject(0, 0));
+    if (!image)
+    {
+      return nullptr;
+    }
+
+    // The blurred background only depends on the HDRI, blur it once in the equirectangular
+    // space instead of blurring the background of each frame.
+    // The kernel is about one degree wide, which is close to the screen space blur
+    // with the default view angle.
+    vtkNew<vtkImageResize> resize;
+    int* dims = image->GetDimensions();
+    constexpr int blurredWidth = 1024;
+    if (dims[0] > blurredWidth)
+    {
+      resize->SetInputData(image);
+      resize->SetOutputDimensions(blurredWidth, std::max(1, dims[1] * blurredWidth / dims[0]), 1);
+      resize->Update();
+      image = resize->GetOutput();
+    }
+
+    vtkDataArray* scalars = image->GetPointData()->GetScalars();
+    int* blurredDims = image->GetDimensions();
+    blurred = vtkSmartPointer<vtkImageData>::New();
+    blurred->CopyStructure(image);
+    blurred->AllocateScalars(scalars->GetDataType(), scalars->GetNumberOfComponents());
+    double sigma = 0.75 * blurredDims[0] / 360.0;
+    switch (scalars->GetDataType())
+    {
+      vtkTemplateMacro(::BlurEquirectangular(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)),
+        static_cast<VTK_TT*>(blurred->GetScalarPointer()), blurredDims[0], blurredDims[1],
+        scalars->GetNumberOfComponents(), sigma));
+      default:
+        return nullptr;
+    }
+    this->SaveImage(blurred, "_blurred");
+  }
+
+  this->BlurredTexture = this->CreateTexture(blurred);
+  return this->BlurredTexture;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DHDRICache::SetEnvironmentTexture(vtkTexture* texture)
+{
+  if (this->EnvironmentTexture != texture)
+  {
+    this->EnvironmentTexture = texture;
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkTexture* vtkF3DHDRICache::GetEnvironmentTexture()
+{
+  return this->EnvironmentTexture;
+}
+
+//----------------------------------------------------------------------------
+vtkPBRIrradianceTexture* vtkF3DHDRICache::GetIrradianceTexture()
+{
+  if (!this->IrradianceTexture)
+  {
+    this->IrradianceTexture = vtkSmartPointer<vtkPBRIrradianceTexture>::New();
+  }
+  return this->IrradianceTexture;
+}
+
+//----------------------------------------------------------------------------
+vtkPBRPrefilterTexture* vtkF3DHDRICache::GetPrefilterTexture()
+{
+  if (!this->PrefilterTexture)
+  {
+    this->PrefilterTexture = vtkSmartPointer<vtkPBRPrefilterTexture>::New();
+  }
+  return this->PrefilterTexture;
+}
+
+//----------------------------------------------------------------------------
+vtkPBRLUTTexture* vtkF3DHDRICache::GetLookupTableTexture()
+{
+  if (!this->LookupTableTexture)
+  {
+    this->LookupTableTexture = vtkSmartPointer<vtkPBRLUTTexture>::New();
+  }
+  return this->LookupTableTexture;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkTexture> vtkF3DHDRICache::CreateTexture(vtkImageData* image)
+{
+  vtkNew<vtkTexture> texture;
+  texture->SetColorModeToDirectScalars();
+  texture->MipmapOn();
+  texture->InterpolateOn();
+  texture->SetInputData(image);
+
+  // 8-bit textures are usually gamma-corrected
+  if (image->GetScalarType() == VTK_UNSIGNED_CHAR)
+  {
+    texture->UseSRGBColorSpaceOn();
+  }
+
+  return texture.Get();
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> vtkF3DHDRICache::LoadImage(const std::string& suffix)
+{
+  if (this->Hash.empty())
+  {
+    return nullptr;
+  }
+
+  std::string fileName =
+    vtksys::SystemTools::CollapseFullPath(this->Hash + suffix + ".vti", this->Directory);
+  if (!vtksys::SystemTools::FileExists(fileName))
+  {
+    return nullptr;
+  }
+
+  vtkNew<vtkXMLImageDataReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->Update();
+
+  vtkImageData* image = reader->GetOutput();
+  if (reader->GetErrorCode() != 0 || !image || !image->GetPointData()->GetScalars())
+  {
+    F3DLog::Print(F3DLog::Severity::Warning, "Cannot read the cached HDRI ", fileName);
+    return nullptr;
+  }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DHDRICache::SaveImage(vtkImageData* image, const std::string& suffix)
+{
+  if (this->Hash.empty() || !vtksys::SystemTools::MakeDirectory(this->Directory))
+  {
+    return;
+  }
+
+  std::string fileName =
+    vtksys::SystemTools::CollapseFullPath(this->Hash + suffix + ".vti", this->Directory);
+
+  // write in a temporary file first so another process never reads a partial file
+  std::string tmpFileName = fileName + ".tmp";
+  vtkNew<vtkXMLImageDataWriter> writer;
+  writer->SetInputData(image);
+  writer->SetFileName(tmpFileName.c_str());
+  writer->SetCompressorTypeToLZ4();
+  if (writer->Write() != 1)
+  {
+    vtksys::SystemTools::RemoveFile(tmpFileName);
+    return;
+  }
+  vtksys::SystemTools::RenameFile(tmpFileName, fileName);
+}
@@ -0,0 +1,114 @@
+/**
+ * @class   vtkF3DHDRICache
+ * @brief   Keep the HDRI and its image based lighting textures between renderers
+ *
+ * F3D creates a new renderer for each loaded file. vtkF3DHDRICache keeps the texture of the
+ * HDRI, its blurred version and the textures VTK precomputes on the GPU for the image based
+ * lighting, so that loading another file with the same HDRI neither reads the HDRI again nor
+ * recomputes these textures.
+ * If a directory is set, the decoded and blurred images are also stored in it, keyed by a hash
+ * of the content of the HDRI file, and loaded instead of being computed by the next processes.
+ *
+ * @sa
+ * vtkF3DRenderer
+ */
+
+#ifndef vtkF3DHDRICache_h
+#define vtkF3DHDRICache_h
+
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+#include <string>
+
+class vtkImageData;
+class vtkPBRIrradianceTexture;
+class vtkPBRLUTTexture;
+class vtkPBRPrefilterTexture;
+class vtkTexture;
+
+class vtkF3DHDRICache : public vtkObject
+{
+public:
+  static vtkF3DHDRICache* New();
+  vtkTypeMacro(vtkF3DHDRICache, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /**
+   * Get the texture of a HDRI file. The file is read only if it differs from the file of the
+   * previous call or if it has been modified since.
+   * Returns nullptr if the file cannot be read.
+   */
+  vtkTexture* GetTexture(const std::string& fileName);
+
+  /**
+   * Get the blurred version of the current texture, computed only once, for the prefiltered
+   * background blur.
+   * Returns nullptr if there is no current texture.
+   */
+  vtkTexture* GetBlurredTexture();
+
+  //@{
+  /**
+   * Set/Get the environment texture as stored by the renderer, which may be a cube map
+   * converted from the current texture. It is reset when the HDRI changes.
+   */
+  void SetEnvironmentTexture(vtkTexture* texture);
+  vtkTexture* GetEnvironmentTexture();
+  //@}
+
+  //@{
+  /**
+   * Get the image based lighting textures, created on the first call.
+   * They are computed by the renderers using them and only recomputed when their input changes.
+   */
+  vtkPBRIrradianceTexture* GetIrradianceTexture();
+  vtkPBRPrefilterTexture* GetPrefilterTexture();
+  vtkPBRLUTTexture* GetLookupTableTexture();
+  //@}
+
+  //@{
+  /**
+   * Set/Get the directory where the decoded and blurred images are stored.
+   * Nothing is stored on disk if empty, which is the default.
+   */
+  vtkSetMacro(Directory, std::string);
+  vtkGetMacro(Directory, std::string);
+  //@}
+
+protected:
+  vtkF3DHDRICache();
+  ~vtkF3DHDRICache() override;
+
+  /**
+   * Create a texture using the image, with the same settings for the HDRI and its blurred version
+   */
+  vtkSmartPointer<vtkTexture> CreateTexture(vtkImageData* image);
+
+  //@{
+  /**
+   * Load and save the images of the current HDRI in the directory, using the suffix
+   * to distinguish the blurred image
+   */
+  vtkSmartPointer<vtkImageData> LoadImage(const std::string& suffix);
+  void SaveImage(vtkImageData* image, const std::string& suffix);
+  //@}
+
+  std::string FileName;
+  long int FileModifiedTime = 0;
+  std::string Hash;
+  std::string Directory;
+
+  vtkSmartPointer<vtkTexture> Texture;
+  vtkSmartPointer<vtkTexture> BlurredTexture;
+  vtkSmartPointer<vtkTexture> EnvironmentTexture;
+  vtkSmartPointer<vtkPBRIrradianceTexture> IrradianceTexture;
+  vtkSmartPointer<vtkPBRPrefilterTexture> PrefilterTexture;
+  vtkSmartPointer<vtkPBRLUTTexture> LookupTableTexture;
+
+private:
+  vtkF3DHDRICache(const vtkF3DHDRICache&) = delete;
+  void operator=(const vtkF3DHDRICache&) = delete;
+};
+
+#endif
@@ -172,7 +172,7 @@ void vtkF3DInteractorStyle::OnKeyPress()
       // when going full screen, the OpenGL context changes, we need to reinitialize
       // the interactor, the render passes and the grid actor.
       ren->ShowGrid(ren->IsGridVisible());
-      ren->SetupRenderPasses();
+      ren->ResetRenderPasses();
       rwi->ReInitialize();
 
       renWin->Render();
@@ -373,3 +373,44 @@ bool vtkF3DInteractorStyle::IsUserInteractionBlocked()
 {
   return this->AnimationManager->IsPlaying() && this->Options->CameraIndex >= 0;
 }
+
+//----------------------------------------------------------------------------
+void vtkF3DInteractorStyle::StartState(int newstate)
+{
+  this->Superclass::StartState(newstate);
+
+  vtkF3DRenderer* ren = vtkF3DRenderer::SafeDownCast(this->CurrentRenderer);
+  if (ren && !this->SingleStepInteraction)
+  {
+    ren->SetInteractionInProgress(true);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DInteractorStyle::StopState()
+{
+  // Must be done before the superclass renders the scene
+  vtkF3DRenderer* ren = vtkF3DRenderer::SafeDownCast(this->CurrentRenderer);
+  if (ren)
+  {
+    ren->SetInteractionInProgress(false);
+  }
+
+  this->Superclass::StopState();
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DInteractorStyle::OnMouseWheelForward()
+{
+  this->SingleStepInteraction = true;
+  this->Superclass::OnMouseWheelForward();
+  this->SingleStepInteraction = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DInteractorStyle::OnMouseWheelBackward()
+{
+  this->SingleStepInteraction = true;
+  this->Superclass::OnMouseWheelBackward();
+  this->SingleStepInteraction = false;
+}
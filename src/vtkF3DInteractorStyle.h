@@ -56,6 +56,22 @@ public:
    */
   void EnvironmentRotate() override;
 
+  //@{
+  /**
+   * Overriden to let the renderer know when an interaction is in progress
+   */
+  void StartState(int newstate) override;
+  void StopState() override;
+  //@}
+
+  //@{
+  /**
+   * Overriden to not consider a single mouse wheel step as an interaction in progress
+   */
+  void OnMouseWheelForward() override;
+  void OnMouseWheelBackward() override;
+  //@}
+
   /**
    * Set animation manager
    */
@@ -77,6 +93,8 @@ protected:
   const F3DAnimationManager* AnimationManager = nullptr;
   const F3DOptions* Options = nullptr;
 
+  bool SingleStepInteraction = false;
+
   int WindowSize[2] = { -1, -1 };
   int WindowPos[2] = { 0, 0 };
 };
@@ -30,6 +30,11 @@ public:
    */
   bool IsReaderValid() { return this->InternalReader != nullptr; }
 
+  /**
+   * Get the internal reader, nullptr if the reader is not valid.
+   */
+  vtkGetSmartPointerMacro(InternalReader, vtkAlgorithm);
+
   /**
    * Transfer to the InternalReader
    */
@@ -0,0 +1,230 @@
+#include "vtkF3DOcclusionQueryPass.h"
+
+#include "vtkF3DCuller.h"
+
+#include <vtkMatrix3x3.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkOpenGLBufferObject.h>
+#include <vtkOpenGLCamera.h>
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkOpenGLShaderCache.h>
+#include <vtkOpenGLState.h>
+#include <vtkOpenGLVertexArrayObject.h>
+#include <vtkRenderState.h>
+#include <vtkRenderer.h>
+#include <vtkShaderProgram.h>
+#include <vtk_glew.h>
+
+vtkStandardNewMacro(vtkF3DOcclusionQueryPass);
+
+namespace
+{
+// The box is drawn from a unit cube scaled to the bounds of each prop
+const char* BoxVertexShader = R"(//VTK::System::Dec
+in vec4 vertexMC;
+uniform mat4 WCDCMatrix;
+uniform vec3 boxMin;
+uniform vec3 boxMax;
+
+void main()
+{
+  gl_Position = WCDCMatrix * vec4(mix(boxMin, boxMax, vertexMC.xyz), 1.0);
+}
+)";
+
+const char* BoxFragmentShader = R"(//VTK::System::Dec
+//VTK::Output::Dec
+
+void main()
+{
+  gl_FragData[0] = vec4(1.0);
+}
+)";
+
+// Triangles of the faces of the unit cube
+std::vector<float> GetUnitCube()
+{
+  const int faces[6][4] = { { 0, 2, 6, 4 }, { 1, 5, 7, 3 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 },
+    { 0, 1, 3, 2 }, { 4, 6, 7, 5 } };
+  const int triangles[6] = { 0, 1, 2, 0, 2, 3 };
+  std::vector<float> cube;
+  for (const auto& face : faces)
+  {
+    for (int corner : triangles)
+    {
+      int vertex = face[corner];
+      cube.push_back(static_cast<float>(vertex & 1));
+      cube.push_back(static_cast<float>((vertex >> 1) & 1));
+      cube.push_back(static_cast<float>((vertex >> 2) & 1));
+    }
+  }
+  return cube;
+}
+}
+
+//----------------------------------------------------------------------------
+vtkF3DOcclusionQueryPass::vtkF3DOcclusionQueryPass() = default;
+
+//----------------------------------------------------------------------------
+vtkF3DOcclusionQueryPass::~vtkF3DOcclusionQueryPass() = default;
+
+//----------------------------------------------------------------------------
+void vtkF3DOcclusionQueryPass::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "PendingQueries: " << this->PendingQueries.size() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DOcclusionQueryPass::Render(const vtkRenderState* s)
+{
+  this->NumberOfRenderedProps = 0;
+  if (!this->Culler)
+  {
+    return;
+  }
+
+  this->CollectResults();
+
+  vtkRenderer* ren = s->GetRenderer();
+  vtkOpenGLRenderWindow* renWin = static_cast<vtkOpenGLRenderWindow*>(ren->GetRenderWindow());
+  vtkOpenGLState* ostate = renWin->GetState();
+
+  if (!this->Program)
+  {
+    this->BoxBuffer->Upload(::GetUnitCube(), vtkOpenGLBufferObject::ArrayBuffer);
+  }
+  this->Program = renWin->GetShaderCache()->ReadyShaderProgram(
+    ::BoxVertexShader, ::BoxFragmentShader, "");
+  if (!this->Program)
+  {
+    return;
+  }
+  this->BoxVAO->Bind();
+  this->BoxVAO->AddAttributeArray(
+    this->Program, this->BoxBuffer, "vertexMC", 0, 3 * sizeof(float), VTK_FLOAT, 3, false);
+
+  vtkMatrix4x4* wcvc;
+  vtkMatrix3x3* norms;
+  vtkMatrix4x4* vcdc;
+  vtkMatrix4x4* wcdc;
+  vtkOpenGLCamera* cam = static_cast<vtkOpenGLCamera*>(ren->GetActiveCamera());
+  cam->GetKeyMatrices(ren, wcvc, norms, vcdc, wcdc);
+  this->Program->SetUniformMatrix("WCDCMatrix", wcdc);
+  double position[3];
+  cam->GetPosition(position);
+
+  // the boxes only test the depth buffer of the opaque geometry, both sides of the faces
+  // are drawn in case the near plane clips the box
+  vtkOpenGLState::ScopedglEnableDisable dsaver(ostate, GL_DEPTH_TEST);
+  vtkOpenGLState::ScopedglEnableDisable csaver(ostate, GL_CULL_FACE);
+  vtkOpenGLState::ScopedglEnableDisable bsaver(ostate, GL_BLEND);
+  vtkOpenGLState::ScopedglColorMask colorSaver(ostate);
+  vtkOpenGLState::ScopedglDepthMask depthSaver(ostate);
+  vtkOpenGLState::ScopedglDepthFunc depthFuncSaver(ostate);
+  ostate->vtkglEnable(GL_DEPTH_TEST);
+  ostate->vtkglDisable(GL_CULL_FACE);
+  ostate->vtkglDisable(GL_BLEND);
+  ostate->vtkglColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  ostate->vtkglDepthMask(GL_FALSE);
+  ostate->vtkglDepthFunc(GL_LEQUAL);
+
+  int nbCandidates = this->Culler->GetNumberOfOcclusionCandidates();
+  for (int i = 0; i < nbCandidates; i++)
+  {
+    double bounds[6];
+    vtkProp* prop = this->Culler->GetOcclusionCandidate(i, bounds);
+
+    // a camera inside the box sees the prop even if the faces are hidden
+    bool inside = true;
+    for (int c = 0; c < 3; c++)
+    {
+      inside &= position[c] >= bounds[2 * c] && position[c] <= bounds[2 * c + 1];
+    }
+    if (inside)
+    {
+      this->Culler->SetOccluded(prop, false);
+      continue;
+    }
+
+    float boxMin[3] = { static_cast<float>(bounds[0]), static_cast<float>(bounds[2]),
+      static_cast<float>(bounds[4]) };
+    float boxMax[3] = { static_cast<float>(bounds[1]), static_cast<float>(bounds[3]),
+      static_cast<float>(bounds[5]) };
+    this->Program->SetUniform3f("boxMin", boxMin);
+    this->Program->SetUniform3f("boxMax", boxMax);
+
+    GLuint query;
+    if (this->FreeQueries.empty())
+    {
+      glGenQueries(1, &query);
+    }
+    else
+    {
+      query = this->FreeQueries.back();
+      this->FreeQueries.pop_back();
+    }
+    glBeginQuery(GL_SAMPLES_PASSED, query);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+    glEndQuery(GL_SAMPLES_PASSED);
+    this->PendingQueries.emplace_back(prop, query);
+  }
+
+  this->BoxVAO->Release();
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DOcclusionQueryPass::CollectResults()
+{
+  // a result that is not available yet is considered visible, the GPU is never waited for
+  for (const auto& pending : this->PendingQueries)
+  {
+    GLint available = 0;
+    glGetQueryObjectiv(pending.second, GL_QUERY_RESULT_AVAILABLE, &available);
+    GLuint samples = 1;
+    if (available)
+    {
+      glGetQueryObjectuiv(pending.second, GL_QUERY_RESULT, &samples);
+    }
+    this->Culler->SetOccluded(pending.first, samples == 0);
+    this->FreeQueries.push_back(pending.second);
+  }
+  this->PendingQueries.clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DOcclusionQueryPass::ReleaseGraphicsResources(vtkWindow* vtkNotUsed(w))
+{
+  for (const auto& pending : this->PendingQueries)
+  {
+    this->FreeQueries.push_back(pending.second);
+  }
+  this->PendingQueries.clear();
+  if (!this->FreeQueries.empty())
+  {
+    glDeleteQueries(static_cast<GLsizei>(this->FreeQueries.size()), this->FreeQueries.data());
+    this->FreeQueries.clear();
+  }
+
+  this->BoxVAO->ReleaseGraphicsResources();
+  this->BoxBuffer->ReleaseGraphicsResources();
+  this->Program = nullptr;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DOcclusionQueryPass::SetCuller(vtkF3DCuller* culler)
+{
+  if (this->Culler != culler)
+  {
+    this->Culler = culler;
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkF3DCuller* vtkF3DOcclusionQueryPass::GetCuller()
+{
+  return this->Culler;
+}
@@ -0,0 +1,76 @@
+/**
+ * @class   vtkF3DOcclusionQueryPass
+ * @brief   Test the visibility of the bounding boxes of the props against the depth buffer
+ *
+ * vtkF3DOcclusionQueryPass is rendered after the opaque geometry. It draws the bounding box of
+ * each prop in the view given by a vtkF3DCuller, without writing colors or depths, in an
+ * occlusion query counting the samples passing the depth test.
+ * The results are read in the next frames without waiting for the GPU, a query whose result
+ * is not available yet being considered visible, and given to the culler which skips the
+ * props whose box is hidden. Since the boxes of the hidden props are still tested, they are
+ * rendered again as soon as they appear.
+ *
+ * @sa
+ * vtkF3DCuller
+ */
+
+#ifndef vtkF3DOcclusionQueryPass_h
+#define vtkF3DOcclusionQueryPass_h
+
+#include <vtkNew.h>
+#include <vtkRenderPass.h>
+#include <vtkSmartPointer.h>
+
+#include <utility>
+#include <vector>
+
+class vtkF3DCuller;
+class vtkOpenGLBufferObject;
+class vtkOpenGLVertexArrayObject;
+class vtkProp;
+class vtkShaderProgram;
+
+class vtkF3DOcclusionQueryPass : public vtkRenderPass
+{
+public:
+  static vtkF3DOcclusionQueryPass* New();
+  vtkTypeMacro(vtkF3DOcclusionQueryPass, vtkRenderPass);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  void Render(const vtkRenderState* s) override;
+
+  void ReleaseGraphicsResources(vtkWindow* w) override;
+
+  //@{
+  /**
+   * Set/Get the culler giving the props to test and receiving the results
+   */
+  void SetCuller(vtkF3DCuller* culler);
+  vtkF3DCuller* GetCuller();
+  //@}
+
+protected:
+  vtkF3DOcclusionQueryPass();
+  ~vtkF3DOcclusionQueryPass() override;
+
+  /**
+   * Give the available results of the queries of the previous frames to the culler
+   */
+  void CollectResults();
+
+  vtkSmartPointer<vtkF3DCuller> Culler;
+
+  vtkShaderProgram* Program = nullptr;
+  vtkNew<vtkOpenGLBufferObject> BoxBuffer;
+  vtkNew<vtkOpenGLVertexArrayObject> BoxVAO;
+
+  // queries issued by the previous frame for each prop, and unused queries
+  std::vector<std::pair<vtkProp*, unsigned int> > PendingQueries;
+  std::vector<unsigned int> FreeQueries;
+
+private:
+  vtkF3DOcclusionQueryPass(const vtkF3DOcclusionQueryPass&) = delete;
+  void operator=(const vtkF3DOcclusionQueryPass&) = delete;
+};
+
+#endif
@@ -0,0 +1,499 @@
+#include "vtkF3DPTSReader.h"
+
+#include <vtkFloatArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtkUnsignedCharArray.h>
+
+#if defined(_WIN32)
+#include <vtksys/Encoding.hxx>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+vtkStandardNewMacro(vtkF3DPTSReader);
+
+namespace
+{
+// Size of the chunks parsed in parallel, they are extended to the end of their last line
+constexpr size_t ChunkSize = 4 << 20;
+
+// Number of chunks parsed between two progress updates
+constexpr vtkIdType ChunksPerProgress = 64;
+
+// Maximum number of values of a line: coordinates, intensity and color
+constexpr int MaxValues = 7;
+
+//----------------------------------------------------------------------------
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  void operator=(const MappedFile&) = delete;
+
+  ~MappedFile()
+  {
+#if defined(_WIN32)
+    if (this->Data)
+    {
+      UnmapViewOfFile(this->Data);
+    }
+    if (this->Mapping)
+    {
+      CloseHandle(this->Mapping);
+    }
+    if (this->File != INVALID_HANDLE_VALUE)
+    {
+      CloseHandle(this->File);
+    }
+#else
+    if (this->Data)
+    {
+      munmap(const_cast<char*>(this->Data), this->Size);
+    }
+    if (this->File >= 0)
+    {
+      close(this->File);
+    }
+#endif
+  }
+
+  bool Open(const std::string& fileName)
+  {
+#if defined(_WIN32)
+    this->File = CreateFileW(vtksys::Encoding::ToWide(fileName).c_str(), GENERIC_READ,
+      FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    LARGE_INTEGER size;
+    if (this->File == INVALID_HANDLE_VALUE || !GetFileSizeEx(this->File, &size))
+    {
+      return false;
+    }
+    this->Size = static_cast<size_t>(size.QuadPart);
+    if (this->Size == 0)
+    {
+      return true;
+    }
+    this->Mapping = CreateFileMappingW(this->File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!this->Mapping)
+    {
+      return false;
+    }
+    this->Data = static_cast<const char*>(MapViewOfFile(this->Mapping, FILE_MAP_READ, 0, 0, 0));
+    return this->Data != nullptr;
+#else
+    this->File = open(fileName.c_str(), O_RDONLY);
+    struct stat status;
+    if (this->File < 0 || fstat(this->File, &status) != 0)
+    {
+      return false;
+    }
+    this->Size = static_cast<size_t>(status.st_size);
+    if (this->Size == 0)
+    {
+      return true;
+    }
+    void* data = mmap(nullptr, this->Size, PROT_READ, MAP_PRIVATE, this->File, 0);
+    if (data == MAP_FAILED)
+    {
+      return false;
+    }
+    madvise(data, this->Size, MADV_SEQUENTIAL);
+    this->Data = static_cast<const char*>(data);
+    return true;
+#endif
+  }
+
+  const char* Begin() const { return this->Data; }
+  const char* End() const { return this->Data + this->Size; }
+
+private:
+#if defined(_WIN32)
+  HANDLE File = INVALID_HANDLE_VALUE;
+  HANDLE Mapping = nullptr;
+#else
+  int File = -1;
+#endif
+  const char* Data = nullptr;
+  size_t Size = 0;
+};
+
+//----------------------------------------------------------------------------
+bool IsSeparator(char c)
+{
+  return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+//----------------------------------------------------------------------------
+const char* FindLineEnd(const char* it, const char* end)
+{
+  const char* lineEnd = static_cast<const char*>(std::memchr(it, '\n', end - it));
+  return lineEnd ? lineEnd : end;
+}
+
+//----------------------------------------------------------------------------
+bool IsBlank(const char* it, const char* lineEnd)
+{
+  return std::all_of(it, lineEnd, IsSeparator);
+}
+
+//----------------------------------------------------------------------------
+// Parse a decimal number at the beginning of the range, whatever the locale.
+// Return false if there is no number.
+bool ParseNumber(const char*& it, const char* end, double& value)
+{
+  while (it != end && IsSeparator(*it))
+  {
+    it++;
+  }
+
+  bool negative = false;
+  if (it != end && (*it == '-' || *it == '+'))
+  {
+    negative = *it == '-';
+    it++;
+  }
+
+  // the digits after the 19th do not fit in the mantissa and only change the exponent
+  std::uint64_t mantissa = 0;
+  int exponent = 0;
+  int nbDigits = 0;
+  int nbSignificantDigits = 0;
+  for (; it != end && *it >= '0' && *it <= '9'; it++, nbDigits++)
+  {
+    if (nbSignificantDigits < 19)
+    {
+      mantissa = mantissa * 10 + static_cast<std::uint64_t>(*it - '0');
+      nbSignificantDigits += mantissa != 0 ? 1 : 0;
+    }
+    else
+    {
+      exponent++;
+    }
+  }
+  if (it != end && *it == '.')
+  {
+    for (it++; it != end && *it >= '0' && *it <= '9'; it++, nbDigits++)
+    {
+      if (nbSignificantDigits < 19)
+      {
+        mantissa = mantissa * 10 + static_cast<std::uint64_t>(*it - '0');
+        nbSignificantDigits += mantissa != 0 ? 1 : 0;
+        exponent--;
+      }
+    }
+  }
+  if (nbDigits == 0)
+  {
+    return false;
+  }
+
+  if (it != end && (*it == 'e' || *it == 'E'))
+  {
+    const char* exponentIt = it + 1;
+    bool negativeExponent = false;
+    if (exponentIt != end && (*exponentIt == '-' || *exponentIt == '+'))
+    {
+      negativeExponent = *exponentIt == '-';
+      exponentIt++;
+    }
+    if (exponentIt != end && *exponentIt >= '0' && *exponentIt <= '9')
+    {
+      int explicitExponent = 0;
+      for (; exponentIt != end && *exponentIt >= '0' && *exponentIt <= '9'; exponentIt++)
+      {
+        explicitExponent = std::min(explicitExponent * 10 + (*exponentIt - '0'), 9999);
+      }
+      exponent += negativeExponent ? -explicitExponent : explicitExponent;
+      it = exponentIt;
+    }
+  }
+
+  // powers of ten exactly representable as doubles
+  static const double powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+  double result = static_cast<double>(mantissa);
+  if (exponent >= 0)
+  {
+    result *= exponent <= 22 ? powersOfTen[exponent] : std::pow(10.0, exponent);
+  }
+  else
+  {
+    result /= exponent >= -22 ? powersOfTen[-exponent] : std::pow(10.0, -exponent);
+  }
+  value = negative ? -result : result;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int ParseLine(const char* it, const char* lineEnd, double values[MaxValues])
+{
+  int nbValues = 0;
+  while (nbValues < MaxValues && ParseNumber(it, lineEnd, values[nbValues]))
+  {
+    nbValues++;
+  }
+  return nbValues;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType CountPoints(const char* it, const char* end)
+{
+  vtkIdType count = 0;
+  while (it < end)
+  {
+    const char* lineEnd = FindLineEnd(it, end);
+    count += IsBlank(it, lineEnd) ? 0 : 1;
+    it = lineEnd + 1;
+  }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+struct PointArrays
+{
+  float* Coordinates;
+  float* Intensities;
+  unsigned char* Colors;
+  int ColorOffset;
+};
+
+//----------------------------------------------------------------------------
+// Parse the points of the chunk from the given index, return the number of invalid lines,
+// whose points have NaN coordinates
+vtkIdType ParsePoints(const char* it, const char* end, vtkIdType index, const PointArrays& arrays)
+{
+  vtkIdType nbInvalid = 0;
+  double values[MaxValues];
+  while (it < end)
+  {
+    const char* lineEnd = FindLineEnd(it, end);
+    if (IsBlank(it, lineEnd))
+    {
+      it = lineEnd + 1;
+      continue;
+    }
+
+    int nbValues = ParseLine(it, lineEnd, values);
+    it = lineEnd + 1;
+
+    float* coordinates = arrays.Coordinates + 3 * index;
+    if (nbValues < 3)
+    {
+      std::fill(coordinates, coordinates + 3, std::numeric_limits<float>::quiet_NaN());
+      nbInvalid++;
+    }
+    else
+    {
+      std::fill(values + nbValues, values + MaxValues, 0.0);
+      for (int c = 0; c < 3; c++)
+      {
+        coordinates[c] = static_cast<float>(values[c]);
+      }
+      if (arrays.Intensities)
+      {
+        arrays.Intensities[index] = static_cast<float>(values[3]);
+      }
+      if (arrays.Colors)
+      {
+        for (int c = 0; c < 3; c++)
+        {
+          double color = std::min(std::max(values[arrays.ColorOffset + c], 0.0), 255.0);
+          arrays.Colors[3 * index + c] = static_cast<unsigned char>(color);
+        }
+      }
+    }
+    index++;
+  }
+  return nbInvalid;
+}
+}
+
+//----------------------------------------------------------------------------
+vtkF3DPTSReader::vtkF3DPTSReader()
+{
+  this->SetNumberOfInputPorts(0);
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DPTSReader::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "FileName: " << this->FileName << "\n";
+}
+
+//----------------------------------------------------------------------------
+int vtkF3DPTSReader::RequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector), vtkInformationVector* outputVector)
+{
+  vtkPolyData* output = vtkPolyData::GetData(outputVector);
+
+  MappedFile file;
+  if (!file.Open(this->FileName))
+  {
+    vtkErrorMacro("Cannot open file " << this->FileName);
+    return 0;
+  }
+  const char* begin = file.Begin();
+  const char* end = file.End();
+
+  // the first line may contain the number of points only
+  double values[::MaxValues];
+  const char* lineEnd = ::FindLineEnd(begin, end);
+  if (begin != end && ::ParseLine(begin, lineEnd, values) == 1)
+  {
+    begin = std::min(lineEnd + 1, end);
+  }
+
+  // the format is given by the first point
+  const char* it = begin;
+  lineEnd = ::FindLineEnd(it, end);
+  while (it < end && ::IsBlank(it, lineEnd))
+  {
+    it = lineEnd + 1;
+    lineEnd = ::FindLineEnd(it, end);
+  }
+  int nbColumns = it < end ? ::ParseLine(it, lineEnd, values) : 0;
+  if (nbColumns < 3)
+  {
+    vtkWarningMacro("No point found in " << this->FileName);
+    return 1;
+  }
+
+  // chunks of complete lines
+  std::vector<const char*> chunks;
+  for (it = begin; it < end;)
+  {
+    chunks.push_back(it);
+    const char* chunkEnd = begin + std::min(static_cast<size_t>(it - begin) + ::ChunkSize,
+                                     static_cast<size_t>(end - begin));
+    it = chunkEnd == end ? end : ::FindLineEnd(chunkEnd, end) + 1;
+  }
+  vtkIdType nbChunks = static_cast<vtkIdType>(chunks.size());
+  chunks.push_back(end);
+
+  // count the points of each chunk to know where to write them
+  std::vector<vtkIdType> offsets(nbChunks + 1, 0);
+  vtkSMPTools::For(0, nbChunks, [&](vtkIdType first, vtkIdType last) {
+    for (vtkIdType chunk = first; chunk < last; chunk++)
+    {
+      offsets[chunk + 1] = ::CountPoints(chunks[chunk], chunks[chunk + 1]);
+    }
+  });
+  for (vtkIdType chunk = 0; chunk < nbChunks; chunk++)
+  {
+    offsets[chunk + 1] += offsets[chunk];
+  }
+  vtkIdType nbPoints = offsets.back();
+
+  vtkNew<vtkFloatArray> coordinates;
+  coordinates->SetNumberOfComponents(3);
+  coordinates->SetNumberOfTuples(nbPoints);
+
+  ::PointArrays arrays = { coordinates->GetPointer(0), nullptr, nullptr, 3 };
+
+  vtkNew<vtkFloatArray> intensities;
+  if (nbColumns == 4 || nbColumns >= 7)
+  {
+    intensities->SetName("Intensities");
+    intensities->SetNumberOfTuples(nbPoints);
+    arrays.Intensities = intensities->GetPointer(0);
+    arrays.ColorOffset = 4;
+  }
+
+  vtkNew<vtkUnsignedCharArray> colors;
+  if (nbColumns >= 6)
+  {
+    colors->SetName("Color");
+    colors->SetNumberOfComponents(3);
+    colors->SetNumberOfTuples(nbPoints);
+    arrays.Colors = colors->GetPointer(0);
+  }
+
+  // parse the chunks in parallel, updating the progress between batches of chunks
+  vtkIdType nbInvalid = 0;
+  for (vtkIdType batch = 0; batch < nbChunks; batch += ::ChunksPerProgress)
+  {
+    vtkIdType batchEnd = std::min(batch + ::ChunksPerProgress, nbChunks);
+    std::vector<vtkIdType> invalid(batchEnd - batch, 0);
+    vtkSMPTools::For(batch, batchEnd, [&](vtkIdType first, vtkIdType last) {
+      for (vtkIdType chunk = first; chunk < last; chunk++)
+      {
+        invalid[chunk - batch] =
+          ::ParsePoints(chunks[chunk], chunks[chunk + 1], offsets[chunk], arrays);
+      }
+    });
+    for (vtkIdType count : invalid)
+    {
+      nbInvalid += count;
+    }
+    this->UpdateProgress(static_cast<double>(batchEnd) / nbChunks);
+  }
+
+  // remove the points of the invalid lines, which should be rare
+  if (nbInvalid > 0)
+  {
+    vtkWarningMacro(<< nbInvalid << " invalid lines ignored in " << this->FileName);
+    vtkIdType nbValid = 0;
+    for (vtkIdType id = 0; id < nbPoints; id++)
+    {
+      if (std::isnan(arrays.Coordinates[3 * id]))
+      {
+        continue;
+      }
+      std::copy(arrays.Coordinates + 3 * id, arrays.Coordinates + 3 * id + 3,
+        arrays.Coordinates + 3 * nbValid);
+      if (arrays.Intensities)
+      {
+        arrays.Intensities[nbValid] = arrays.Intensities[id];
+      }
+      if (arrays.Colors)
+      {
+        std::copy(arrays.Colors + 3 * id, arrays.Colors + 3 * id + 3, arrays.Colors + 3 * nbValid);
+      }
+      nbValid++;
+    }
+    nbPoints = nbValid;
+    coordinates->SetNumberOfTuples(nbPoints);
+    if (arrays.Intensities)
+    {
+      intensities->SetNumberOfTuples(nbPoints);
+    }
+    if (arrays.Colors)
+    {
+      colors->SetNumberOfTuples(nbPoints);
+    }
+  }
+
+  vtkNew<vtkPoints> points;
+  points->SetData(coordinates);
+  output->SetPoints(points);
+  if (arrays.Intensities)
+  {
+    output->GetPointData()->AddArray(intensities);
+  }
+  if (arrays.Colors)
+  {
+    output->GetPointData()->SetScalars(colors);
+  }
+
+  return 1;
+}
@@ -0,0 +1,53 @@
+/**
+ * @class   vtkF3DPTSReader
+ * @brief   Parallel reader of PTS point clouds
+ *
+ * vtkF3DPTSReader reads the ASCII PTS files produced by laser scanners: an optional first line
+ * with the number of points, then one point per line with its coordinates and optionally
+ * its intensity and its RGB color.
+ * The file is memory-mapped and split into chunks aligned on the lines, which are parsed in
+ * parallel using vtkSMPTools, with a number parser independent of the locale.
+ * The lines are counted first so that the arrays are allocated once and filled in place.
+ * The point data arrays are named as the ones of vtkPTSReader, but no cell is created.
+ *
+ * @sa
+ * vtkPTSReader
+ */
+
+#ifndef vtkF3DPTSReader_h
+#define vtkF3DPTSReader_h
+
+#include <vtkPolyDataAlgorithm.h>
+
+#include <string>
+
+class vtkF3DPTSReader : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkF3DPTSReader* New();
+  vtkTypeMacro(vtkF3DPTSReader, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  //@{
+  /**
+   * Set/Get the name of the file to read
+   */
+  vtkSetMacro(FileName, std::string);
+  vtkGetMacro(FileName, std::string);
+  //@}
+
+protected:
+  vtkF3DPTSReader();
+  ~vtkF3DPTSReader() override = default;
+
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+
+  std::string FileName;
+
+private:
+  vtkF3DPTSReader(const vtkF3DPTSReader&) = delete;
+  void operator=(const vtkF3DPTSReader&) = delete;
+};
+
+#endif
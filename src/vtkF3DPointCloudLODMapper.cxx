@@ -0,0 +1,171 @@
+#include "vtkF3DPointCloudLODMapper.h"
+
+#include "vtkF3DPointCloudOctree.h"
+
+#include <vtkIdList.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+#include <chrono>
+
+vtkStandardNewMacro(vtkF3DPointCloudLODMapper);
+
+//----------------------------------------------------------------------------
+vtkF3DPointCloudLODMapper::vtkF3DPointCloudLODMapper()
+{
+  this->Octree = vtkSmartPointer<vtkF3DPointCloudOctree>::New();
+}
+
+//----------------------------------------------------------------------------
+vtkF3DPointCloudLODMapper::~vtkF3DPointCloudLODMapper()
+{
+  if (this->SelectionThread.joinable())
+  {
+    this->SelectionThread.join();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DPointCloudLODMapper::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "PointBudget: " << this->PointBudget << "\n";
+  os << indent << "Interactive: " << this->Interactive << "\n";
+  os << indent << "NumberOfRenderedPoints: " << this->NumberOfRenderedPoints << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DPointCloudLODMapper::Render(vtkRenderer* ren, vtkActor* act)
+{
+  this->Update();
+  vtkPolyData* input = this->GetInput();
+  if (this->PointBudget <= 0 || !input || !input->GetPoints() ||
+    input->GetNumberOfPoints() <= this->PointBudget)
+  {
+    this->NumberOfRenderedPoints = input ? input->GetNumberOfPoints() : 0;
+    this->Superclass::Render(ren, act);
+    return;
+  }
+
+  if (input->GetMTime() > this->OctreeBuildTime)
+  {
+    this->CollectSelection();
+    this->Octree->Build(input->GetPoints());
+    this->OctreeBuildTime.Modified();
+    this->DisplayedNodes.clear();
+    this->Delegate->SetInputData(nullptr);
+  }
+
+  // a background extraction is used as soon as it is available
+  if (this->PendingSelection.valid() &&
+    (!this->Interactive ||
+      this->PendingSelection.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+  {
+    this->CollectSelection();
+  }
+
+  std::vector<int> nodes;
+  this->Octree->Select(vtkF3DPointCloudOctree::GetView(ren), this->PointBudget, nodes);
+  if (nodes != this->DisplayedNodes)
+  {
+    if (!this->Interactive || !this->Delegate->GetInput())
+    {
+      Selection selection = vtkF3DPointCloudLODMapper::ExtractPoints(input, this->Octree, nodes);
+      this->DisplayedNodes = selection.Nodes;
+      this->Delegate->SetInputData(selection.Points);
+    }
+    else if (!this->PendingSelection.valid())
+    {
+      // the thread works on its own shallow copy of the input
+      vtkSmartPointer<vtkPolyData> points = vtkSmartPointer<vtkPolyData>::New();
+      points->ShallowCopy(input);
+      vtkSmartPointer<vtkF3DPointCloudOctree> octree = this->Octree;
+
+      std::packaged_task<Selection()> task([points, octree, nodes]() {
+        return vtkF3DPointCloudLODMapper::ExtractPoints(points, octree, nodes);
+      });
+      this->PendingSelection = task.get_future();
+      this->SelectionThread = std::thread(std::move(task));
+    }
+  }
+
+  vtkPolyData* displayed = this->Delegate->GetInput();
+  this->NumberOfRenderedPoints = displayed ? displayed->GetNumberOfPoints() : 0;
+
+  this->UpdateDelegate();
+  this->Delegate->Render(ren, act);
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DPointCloudLODMapper::CollectSelection()
+{
+  if (!this->PendingSelection.valid())
+  {
+    return;
+  }
+
+  Selection selection = this->PendingSelection.get();
+  this->SelectionThread.join();
+
+  if (this->OctreeBuildTime < this->GetInput()->GetMTime())
+  {
+    // the selection was extracted from a previous input
+    return;
+  }
+  this->DisplayedNodes = selection.Nodes;
+  this->Delegate->SetInputData(selection.Points);
+}
+
+//----------------------------------------------------------------------------
+vtkF3DPointCloudLODMapper::Selection vtkF3DPointCloudLODMapper::ExtractPoints(
+  vtkPolyData* input, const vtkF3DPointCloudOctree* octree, const std::vector<int>& nodes)
+{
+  vtkNew<vtkIdList> ids;
+  octree->GetPointIds(nodes, ids);
+  vtkIdType nbPoints = ids->GetNumberOfIds();
+
+  vtkNew<vtkPoints> points;
+  points->SetDataType(input->GetPoints()->GetDataType());
+  input->GetPoints()->GetPoints(ids, points);
+
+  vtkNew<vtkIdList> outputIds;
+  outputIds->SetNumberOfIds(nbPoints);
+  for (vtkIdType i = 0; i < nbPoints; i++)
+  {
+    outputIds->SetId(i, i);
+  }
+
+  Selection selection;
+  selection.Nodes = nodes;
+  selection.Points = vtkSmartPointer<vtkPolyData>::New();
+  selection.Points->SetPoints(points);
+  selection.Points->GetPointData()->CopyAllocate(input->GetPointData(), nbPoints);
+  selection.Points->GetPointData()->CopyData(input->GetPointData(), ids, outputIds);
+  return selection;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DPointCloudLODMapper::UpdateDelegate()
+{
+  // only modify the internal mapper when the coloring actually changed
+  this->Delegate->SetLookupTable(this->GetLookupTable());
+  this->Delegate->SetScalarVisibility(this->GetScalarVisibility());
+  this->Delegate->SetScalarMode(this->GetScalarMode());
+  this->Delegate->SetColorMode(this->GetColorMode());
+  this->Delegate->SetScalarRange(this->GetScalarRange());
+  this->Delegate->SetInterpolateScalarsBeforeMapping(this->GetInterpolateScalarsBeforeMapping());
+  this->Delegate->SelectColorArray(this->GetArrayName());
+  this->Delegate->SetScaleFactor(this->GetScaleFactor());
+  this->Delegate->SetEmissive(this->GetEmissive());
+  this->Delegate->SetSplatShaderCode(this->GetSplatShaderCode());
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DPointCloudLODMapper::ReleaseGraphicsResources(vtkWindow* w)
+{
+  this->Delegate->ReleaseGraphicsResources(w);
+  this->Superclass::ReleaseGraphicsResources(w);
+}
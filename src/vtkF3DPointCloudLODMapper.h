@@ -0,0 +1,106 @@
+/**
+ * @class   vtkF3DPointCloudLODMapper
+ * @brief   Point gaussian mapper rendering a point cloud within a point budget
+ *
+ * vtkF3DPointCloudLODMapper renders its input as vtkOpenGLPointGaussianMapper does when it
+ * has less points than the point budget. Otherwise, a vtkF3DPointCloudOctree of the points is
+ * built on the first render, and only the points of the nodes selected for the current view
+ * are extracted and rendered by an internal mapper using the same coloring.
+ * While interacting, the points are extracted in a background thread and the previous
+ * selection is rendered until they are available.
+ *
+ * @sa
+ * vtkF3DPointCloudOctree
+ */
+
+#ifndef vtkF3DPointCloudLODMapper_h
+#define vtkF3DPointCloudLODMapper_h
+
+#include <vtkNew.h>
+#include <vtkOpenGLPointGaussianMapper.h>
+#include <vtkSmartPointer.h>
+
+#include <future>
+#include <thread>
+#include <vector>
+
+class vtkF3DPointCloudOctree;
+
+class vtkF3DPointCloudLODMapper : public vtkOpenGLPointGaussianMapper
+{
+public:
+  static vtkF3DPointCloudLODMapper* New();
+  vtkTypeMacro(vtkF3DPointCloudLODMapper, vtkOpenGLPointGaussianMapper);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  void Render(vtkRenderer* ren, vtkActor* act) override;
+
+  void ReleaseGraphicsResources(vtkWindow* w) override;
+
+  //@{
+  /**
+   * Set/Get the maximum number of points to render.
+   * Default is 0, which renders all the points.
+   */
+  vtkSetMacro(PointBudget, vtkIdType);
+  vtkGetMacro(PointBudget, vtkIdType);
+  //@}
+
+  //@{
+  /**
+   * Set/Get if the points are extracted in a background thread.
+   * Otherwise, the rendered points always match the view.
+   */
+  vtkSetMacro(Interactive, bool);
+  vtkGetMacro(Interactive, bool);
+  //@}
+
+  /**
+   * Get the number of points rendered by the last render
+   */
+  vtkGetMacro(NumberOfRenderedPoints, vtkIdType);
+
+protected:
+  vtkF3DPointCloudLODMapper();
+  ~vtkF3DPointCloudLODMapper() override;
+
+  struct Selection
+  {
+    std::vector<int> Nodes;
+    vtkSmartPointer<vtkPolyData> Points;
+  };
+
+  /**
+   * Extract the points of the nodes with their point data, can run in any thread
+   */
+  static Selection ExtractPoints(
+    vtkPolyData* input, const vtkF3DPointCloudOctree* octree, const std::vector<int>& nodes);
+
+  /**
+   * Wait for the background extraction if any and render its points
+   */
+  void CollectSelection();
+
+  /**
+   * Copy the coloring parameters to the internal mapper, without modifying it if unchanged
+   */
+  void UpdateDelegate();
+
+  vtkIdType PointBudget = 0;
+  bool Interactive = false;
+  vtkIdType NumberOfRenderedPoints = 0;
+
+  vtkSmartPointer<vtkF3DPointCloudOctree> Octree;
+  vtkTimeStamp OctreeBuildTime;
+  vtkNew<vtkOpenGLPointGaussianMapper> Delegate;
+  std::vector<int> DisplayedNodes;
+
+  std::future<Selection> PendingSelection;
+  std::thread SelectionThread;
+
+private:
+  vtkF3DPointCloudLODMapper(const vtkF3DPointCloudLODMapper&) = delete;
+  void operator=(const vtkF3DPointCloudLODMapper&) = delete;
+};
+
+#endif
@@ -0,0 +1,344 @@
+#include "vtkF3DPointCloudOctree.h"
+
+#include <vtkCamera.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkRenderer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+vtkStandardNewMacro(vtkF3DPointCloudOctree);
+
+namespace
+{
+// Resolution of the grid used to subsample the points of a node, along each axis
+constexpr int GridResolution = 32;
+
+// Nodes with less points than this are not subdivided
+constexpr vtkIdType LeafSize = 65536;
+
+// Maximum depth of the octree, which also stops the subdivision of duplicated points
+constexpr int MaxLevel = 20;
+
+// Access to the coordinates of the points without virtual calls for the common types
+template <class T>
+struct TypedPointAccessor
+{
+  const T* Data;
+  void Get(vtkIdType id, double p[3]) const
+  {
+    const T* coords = this->Data + 3 * id;
+    p[0] = static_cast<double>(coords[0]);
+    p[1] = static_cast<double>(coords[1]);
+    p[2] = static_cast<double>(coords[2]);
+  }
+};
+
+struct GenericPointAccessor
+{
+  vtkPoints* Points;
+  void Get(vtkIdType id, double p[3]) const { this->Points->GetPoint(id, p); }
+};
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DPointCloudOctree::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfPoints: " << this->GetNumberOfPoints() << "\n";
+  os << indent << "NumberOfNodes: " << this->GetNumberOfNodes() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DPointCloudOctree::Build(vtkPoints* points)
+{
+  this->PointIds.clear();
+  this->Nodes.clear();
+  this->Modified();
+
+  vtkIdType nbPoints = points ? points->GetNumberOfPoints() : 0;
+  if (nbPoints == 0)
+  {
+    return;
+  }
+
+  this->PointIds.resize(nbPoints);
+  std::iota(this->PointIds.begin(), this->PointIds.end(), 0);
+
+  // the root is a cube so that the subsampling grid is isotropic
+  double bounds[6];
+  points->GetBounds(bounds);
+  double size = std::max({ bounds[1] - bounds[0], bounds[3] - bounds[2], bounds[5] - bounds[4] });
+  size = size > 0.0 ? size : 1.0;
+  for (int c = 0; c < 3; c++)
+  {
+    bounds[2 * c + 1] = bounds[2 * c] + size;
+  }
+
+  switch (points->GetDataType())
+  {
+    case VTK_FLOAT:
+    {
+      TypedPointAccessor<float> accessor = { static_cast<float*>(points->GetVoidPointer(0)) };
+      this->BuildNode(accessor, bounds, 0, nbPoints, 0);
+      break;
+    }
+    case VTK_DOUBLE:
+    {
+      TypedPointAccessor<double> accessor = { static_cast<double*>(points->GetVoidPointer(0)) };
+      this->BuildNode(accessor, bounds, 0, nbPoints, 0);
+      break;
+    }
+    default:
+    {
+      GenericPointAccessor accessor = { points };
+      this->BuildNode(accessor, bounds, 0, nbPoints, 0);
+      break;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class PointAccessor>
+int vtkF3DPointCloudOctree::BuildNode(const PointAccessor& accessor, const double bounds[6],
+  vtkIdType begin, vtkIdType end, int level)
+{
+  int index = static_cast<int>(this->Nodes.size());
+  Node node;
+  std::copy(bounds, bounds + 6, node.Bounds);
+  node.Spacing = (bounds[1] - bounds[0]) / ::GridResolution;
+  node.Offset = begin;
+  node.Count = end - begin;
+  std::fill(node.Children, node.Children + 8, -1);
+
+  vtkIdType* ids = this->PointIds.data();
+  if (node.Count <= ::LeafSize || level >= ::MaxLevel)
+  {
+    this->Nodes.push_back(node);
+    return index;
+  }
+
+  // keep the first point of each cell of the grid in this node, and move them first
+  std::vector<unsigned char> occupied(::GridResolution * ::GridResolution * ::GridResolution, 0);
+  vtkIdType* sampledEnd = std::partition(ids + begin, ids + end, [&](vtkIdType id) {
+    double p[3];
+    accessor.Get(id, p);
+    int cell = 0;
+    for (int c = 2; c >= 0; c--)
+    {
+      int i = static_cast<int>((p[c] - bounds[2 * c]) / node.Spacing);
+      cell = cell * ::GridResolution + std::min(std::max(i, 0), ::GridResolution - 1);
+    }
+    if (occupied[cell])
+    {
+      return false;
+    }
+    occupied[cell] = 1;
+    return true;
+  });
+  node.Count = sampledEnd - (ids + begin);
+  this->Nodes.push_back(node);
+
+  // sort the other points by octant, the octant index being x + 2 * y + 4 * z
+  double center[3];
+  for (int c = 0; c < 3; c++)
+  {
+    center[c] = 0.5 * (bounds[2 * c] + bounds[2 * c + 1]);
+  }
+  auto below = [&accessor, &center](int c) {
+    return [&accessor, &center, c](vtkIdType id) {
+      double p[3];
+      accessor.Get(id, p);
+      return p[c] < center[c];
+    };
+  };
+
+  vtkIdType* ranges[9];
+  ranges[0] = sampledEnd;
+  ranges[8] = ids + end;
+  ranges[4] = std::partition(ranges[0], ranges[8], below(2));
+  for (int i = 0; i < 8; i += 4)
+  {
+    ranges[i + 2] = std::partition(ranges[i], ranges[i + 4], below(1));
+  }
+  for (int i = 0; i < 8; i += 2)
+  {
+    ranges[i + 1] = std::partition(ranges[i], ranges[i + 2], below(0));
+  }
+
+  for (int i = 0; i < 8; i++)
+  {
+    if (ranges[i + 1] == ranges[i])
+    {
+      continue;
+    }
+
+    double childBounds[6];
+    for (int c = 0; c < 3; c++)
+    {
+      bool upper = ((i >> c) & 1) != 0;
+      childBounds[2 * c] = upper ? center[c] : bounds[2 * c];
+      childBounds[2 * c + 1] = upper ? bounds[2 * c + 1] : center[c];
+    }
+    int child =
+      this->BuildNode(accessor, childBounds, ranges[i] - ids, ranges[i + 1] - ids, level + 1);
+    this->Nodes[index].Children[i] = child;
+  }
+
+  return index;
+}
+
+//----------------------------------------------------------------------------
+double vtkF3DPointCloudOctree::View::GetProjectedSize(const double bounds[6], double length) const
+{
+  if (this->Parallel)
+  {
+    return length * this->PixelsPerUnit;
+  }
+
+  double distance2 = 0.0;
+  for (int c = 0; c < 3; c++)
+  {
+    double d = std::max(
+      { bounds[2 * c] - this->Position[c], this->Position[c] - bounds[2 * c + 1], 0.0 });
+    distance2 += d * d;
+  }
+  if (distance2 == 0.0)
+  {
+    return VTK_DOUBLE_MAX;
+  }
+  return length / std::sqrt(distance2) * this->PixelsPerUnit;
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DPointCloudOctree::View::IsInFrustum(const double bounds[6]) const
+{
+  for (int i = 0; i < 6; i++)
+  {
+    const double* plane = this->Planes + 4 * i;
+    double value = plane[3];
+    for (int c = 0; c < 3; c++)
+    {
+      value += plane[c] * (plane[c] >= 0.0 ? bounds[2 * c + 1] : bounds[2 * c]);
+    }
+    if (value < 0.0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkF3DPointCloudOctree::View vtkF3DPointCloudOctree::GetView(vtkRenderer* ren)
+{
+  View view;
+  vtkCamera* camera = ren->GetActiveCamera();
+  camera->GetFrustumPlanes(ren->GetTiledAspectRatio(), view.Planes);
+  camera->GetPosition(view.Position);
+  view.Parallel = camera->GetParallelProjection() != 0;
+
+  double height = std::max(1, ren->GetSize()[1]);
+  if (view.Parallel)
+  {
+    view.PixelsPerUnit = height / (2.0 * camera->GetParallelScale());
+  }
+  else
+  {
+    view.PixelsPerUnit =
+      height / (2.0 * std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0));
+  }
+  return view;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DPointCloudOctree::Select(
+  const View& view, vtkIdType budget, std::vector<int>& nodes) const
+{
+  nodes.clear();
+  if (this->Nodes.empty())
+  {
+    return;
+  }
+
+  // the nodes looking the biggest on screen are refined first
+  auto priority = [&view](const Node& node) {
+    double diagonal = std::sqrt(3.0) * (node.Bounds[1] - node.Bounds[0]);
+    return view.GetProjectedSize(node.Bounds, diagonal);
+  };
+
+  std::priority_queue<std::pair<double, int> > queue;
+  if (view.IsInFrustum(this->Nodes[0].Bounds))
+  {
+    queue.emplace(priority(this->Nodes[0]), 0);
+  }
+
+  vtkIdType count = 0;
+  while (!queue.empty())
+  {
+    int index = queue.top().second;
+    queue.pop();
+
+    const Node& node = this->Nodes[index];
+    if (!nodes.empty() && count + node.Count > budget)
+    {
+      break;
+    }
+    nodes.push_back(index);
+    count += node.Count;
+
+    // the children only add details smaller than the spacing of this node
+    if (view.GetProjectedSize(node.Bounds, node.Spacing) < 1.0)
+    {
+      continue;
+    }
+
+    for (int child : node.Children)
+    {
+      if (child >= 0 && view.IsInFrustum(this->Nodes[child].Bounds))
+      {
+        queue.emplace(priority(this->Nodes[child]), child);
+      }
+    }
+  }
+
+  std::sort(nodes.begin(), nodes.end());
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DPointCloudOctree::GetPointIds(const std::vector<int>& nodes, vtkIdList* ids) const
+{
+  vtkIdType count = 0;
+  for (int index : nodes)
+  {
+    count += this->Nodes[index].Count;
+  }
+
+  ids->SetNumberOfIds(count);
+  vtkIdType* out = ids->GetPointer(0);
+  for (int index : nodes)
+  {
+    const Node& node = this->Nodes[index];
+    out = std::copy(this->PointIds.begin() + node.Offset,
+      this->PointIds.begin() + node.Offset + node.Count, out);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkF3DPointCloudOctree::GetNumberOfPoints() const
+{
+  return static_cast<vtkIdType>(this->PointIds.size());
+}
+
+//----------------------------------------------------------------------------
+int vtkF3DPointCloudOctree::GetNumberOfNodes() const
+{
+  return static_cast<int>(this->Nodes.size());
+}
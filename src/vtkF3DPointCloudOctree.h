@@ -0,0 +1,119 @@
+/**
+ * @class   vtkF3DPointCloudOctree
+ * @brief   Multi-resolution octree of a point cloud
+ *
+ * vtkF3DPointCloudOctree sorts the points of a cloud into an octree where each node keeps
+ * a subsample of its points, spread on a regular grid, and gives the others to its children.
+ * Rendering the points of a node and of all its ancestors gives an approximation of the
+ * cloud in the node, refined by each level.
+ * Select returns the nodes to render for a view, in the camera frustum, most detailed near
+ * the camera, and within a point budget.
+ * The points themselves are not copied, nodes are ranges of an array of point ids.
+ *
+ * @sa
+ * vtkF3DPointCloudLODMapper
+ */
+
+#ifndef vtkF3DPointCloudOctree_h
+#define vtkF3DPointCloudOctree_h
+
+#include <vtkObject.h>
+
+#include <vector>
+
+class vtkCamera;
+class vtkIdList;
+class vtkPoints;
+class vtkPolyData;
+class vtkRenderer;
+
+class vtkF3DPointCloudOctree : public vtkObject
+{
+public:
+  static vtkF3DPointCloudOctree* New();
+  vtkTypeMacro(vtkF3DPointCloudOctree, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /**
+   * Parameters of a view used to select the nodes, which can be used by another thread
+   */
+  struct View
+  {
+    double Planes[24];
+    double Position[3];
+    bool Parallel;
+
+    // size in pixels of a world unit at a distance of one, or at any distance in parallel
+    double PixelsPerUnit;
+
+    /**
+     * Get the size in pixels of a length located in the bounds, seen from their nearest point
+     */
+    double GetProjectedSize(const double bounds[6], double length) const;
+
+    /**
+     * Test the bounds against the frustum planes, whose normals point inward
+     */
+    bool IsInFrustum(const double bounds[6]) const;
+  };
+
+  /**
+   * Build the octree of the points, discarding the previous one
+   */
+  void Build(vtkPoints* points);
+
+  /**
+   * Get the view parameters of the active camera of a renderer
+   */
+  static View GetView(vtkRenderer* ren);
+
+  /**
+   * Select the nodes to render for the view, refining the nodes until their point spacing
+   * is smaller than a pixel or until the budget is reached. The nodes are sorted.
+   */
+  void Select(const View& view, vtkIdType budget, std::vector<int>& nodes) const;
+
+  /**
+   * Get the ids of the points of the nodes
+   */
+  void GetPointIds(const std::vector<int>& nodes, vtkIdList* ids) const;
+
+  /**
+   * Get the number of points of the octree, or 0 if not built
+   */
+  vtkIdType GetNumberOfPoints() const;
+
+  /**
+   * Get the number of nodes of the octree
+   */
+  int GetNumberOfNodes() const;
+
+protected:
+  vtkF3DPointCloudOctree() = default;
+  ~vtkF3DPointCloudOctree() override = default;
+
+  struct Node
+  {
+    double Bounds[6];
+    double Spacing;
+    vtkIdType Offset;
+    vtkIdType Count;
+    int Children[8];
+  };
+
+  /**
+   * Build the node of the ids between begin and end and its children, return its index
+   */
+  template <class PointAccessor>
+  int BuildNode(const PointAccessor& accessor, const double bounds[6], vtkIdType begin,
+    vtkIdType end, int level);
+
+  std::vector<vtkIdType> PointIds;
+  std::vector<Node> Nodes;
+
+private:
+  vtkF3DPointCloudOctree(const vtkF3DPointCloudOctree&) = delete;
+  void operator=(const vtkF3DPointCloudOctree&) = delete;
+};
+
+#endif
@@ -2,134 +2,272 @@
 
 #include <vtkActor.h>
 #include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationObjectBaseKey.h>
 #include <vtkMatrix4x4.h>
 #include <vtkObjectFactory.h>
+#include <vtkOpenGLBufferObject.h>
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkOpenGLVertexArrayObject.h>
 #include <vtkOpenGLVertexBufferObject.h>
 #include <vtkOpenGLVertexBufferObjectGroup.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkProperty.h>
+#include <vtkRenderer.h>
 #include <vtkShaderProgram.h>
 #include <vtkShaderProperty.h>
+#include <vtkTextureObject.h>
 #include <vtkUniforms.h>
 #include <vtkVersion.h>
+#include <vtk_glew.h>
 
-vtkStandardNewMacro(vtkF3DPolyDataMapper);
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <vector>
 
 //-----------------------------------------------------------------------------
-vtkF3DPolyDataMapper::vtkF3DPolyDataMapper()
+struct vtkF3DJointPalette
 {
-  this->SetVBOShiftScaleMethod(vtkOpenGLVertexBufferObject::DISABLE_SHIFT_SCALE);
+  // must be called with the context of the window current, by the last mapper using it
+  void ReleaseGraphicsResources(vtkWindow* win)
+  {
+    this->Texture->ReleaseGraphicsResources(win);
+    this->Buffer->ReleaseGraphicsResources();
+  }
 
-  // map glTF arrays to GPU VBOs
-  this->MapDataArrayToVertexAttribute(
-    "weights", "WEIGHTS_0", vtkDataObject::FIELD_ASSOCIATION_POINTS);
-  this->MapDataArrayToVertexAttribute(
-    "joints", "JOINTS_0", vtkDataObject::FIELD_ASSOCIATION_POINTS);
-
-  // morph targets
-  // OpenGL limits the input attributes to 16 vectors
-  // We ignore morphing on tangent on purpose to maximize the number of targets we
-  // can support
-  for (int i = 0; i < 4; i++)
-  {
-    std::string name = "target" + std::to_string(i) + "_position";
-    this->MapDataArrayToVertexAttribute(
-      name.c_str(), name.c_str(), vtkDataObject::FIELD_ASSOCIATION_POINTS);
-    name = "target" + std::to_string(i) + "_normal";
-    this->MapDataArrayToVertexAttribute(
-      name.c_str(), name.c_str(), vtkDataObject::FIELD_ASSOCIATION_POINTS);
+  std::vector<float> Matrices;
+  vtkNew<vtkOpenGLBufferObject> Buffer;
+  vtkNew<vtkTextureObject> Texture;
+};
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Joint palettes currently in use by the mappers of a renderer, indexed by content hash.
+// Entries expire as soon as no mapper references them anymore, and the cache is deleted
+// along with the information of the renderer.
+class vtkF3DJointPaletteCache : public vtkObject
+{
+public:
+  static vtkF3DJointPaletteCache* New();
+  vtkTypeMacro(vtkF3DJointPaletteCache, vtkObject);
+
+  std::map<size_t, std::weak_ptr<vtkF3DJointPalette> > Palettes;
+
+protected:
+  vtkF3DJointPaletteCache() = default;
+  ~vtkF3DJointPaletteCache() override = default;
+
+private:
+  vtkF3DJointPaletteCache(const vtkF3DJointPaletteCache&) = delete;
+  void operator=(const vtkF3DJointPaletteCache&) = delete;
+};
+vtkStandardNewMacro(vtkF3DJointPaletteCache);
+
+//-----------------------------------------------------------------------------
+size_t HashMatrices(const std::vector<float>& matrices)
+{
+  size_t hash = matrices.size();
+  std::hash<float> hasher;
+  for (float value : matrices)
+  {
+    hash ^= hasher(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
   }
+  return hash;
 }
 
 //-----------------------------------------------------------------------------
-void vtkF3DPolyDataMapper::ReplaceShaderValues(
-  std::map<vtkShader::Type, vtkShader*> shaders, vtkRenderer* ren, vtkActor* actor)
+// Collect the targetN_position arrays of the point data, with their targetN_normal arrays or
+// nullptr, and return true if there is at least one target
+bool GetMorphTargets(vtkPointData* pointData, std::vector<vtkDataArray*>& positions,
+  std::vector<vtkDataArray*>& normals)
 {
-  auto vertexShader = shaders[vtkShader::Vertex];
-  auto VSSource = vertexShader->GetSource();
+  for (;;)
+  {
+    std::string prefix = "target" + std::to_string(positions.size());
+    vtkDataArray* position = pointData->GetArray((prefix + "_position").c_str());
+    if (!position || position->GetNumberOfComponents() != 3)
+    {
+      break;
+    }
+    vtkDataArray* normal = pointData->GetArray((prefix + "_normal").c_str());
+    if (normal && normal->GetNumberOfComponents() != 3)
+    {
+      normal = nullptr;
+    }
+    positions.push_back(position);
+    normals.push_back(normal);
+  }
+  return !positions.empty();
+}
 
-  bool hasTangents = this->VBOs->GetNumberOfComponents("tangentMC") == 3 && actor->GetProperty()->GetLighting();
-  bool hasNormals = this->VBOs->GetNumberOfComponents("normalMC") == 3 && actor->GetProperty()->GetLighting();
+//-----------------------------------------------------------------------------
+// Encode a direction on the octahedron unfolded in a square, as two normalized shorts
+void EncodeOctahedral(const double direction[3], short encoded[2])
+{
+  double norm = std::abs(direction[0]) + std::abs(direction[1]) + std::abs(direction[2]);
+  double x = norm > 0.0 ? direction[0] / norm : 0.0;
+  double y = norm > 0.0 ? direction[1] / norm : 0.0;
+  if (direction[2] < 0.0)
+  {
+    double foldedX = (1.0 - std::abs(y)) * (x >= 0.0 ? 1.0 : -1.0);
+    double foldedY = (1.0 - std::abs(x)) * (y >= 0.0 ? 1.0 : -1.0);
+    x = foldedX;
+    y = foldedY;
+  }
+  encoded[0] = static_cast<short>(std::round(std::min(std::max(x, -1.0), 1.0) * 32767.0));
+  encoded[1] = static_cast<short>(std::round(std::min(std::max(y, -1.0), 1.0) * 32767.0));
+}
 
-  vtkUniforms* uniforms = actor->GetShaderProperty()->GetVertexCustomUniforms();
+//-----------------------------------------------------------------------------
+// Features of the vertex shader, combined in a key selecting its variant
+enum ShaderFeature
+{
+  Normals = 1 << 0,
+  Tangents = 1 << 1,
+  CompactNormals = 1 << 2,
+  CompactTangents = 1 << 3,
+  CompactTCoords = 1 << 4,
+  Morphing = 1 << 5,
+  MorphNormals = 1 << 6,
+  Skinning = 1 << 7,
+  VertexVC = 1 << 8,
+  CompactPositions = 1 << 9
+};
+
+// Features handled by the superclass alone, without custom code
+constexpr unsigned int PlainFeatures = Normals | Tangents | VertexVC;
+
+// Custom code replacing the tags of the vertex shader
+struct ShaderVariant
+{
+  std::string CustomDecl;
+  std::string BeginImpl;
+  std::string PositionImpl;
+  std::string NormalImpl;
+};
+
+//-----------------------------------------------------------------------------
+// Generated variants indexed by their features, shared by all the mappers since they only
+// contain sources
+std::map<unsigned int, ShaderVariant> ShaderVariants;
+
+//-----------------------------------------------------------------------------
+ShaderVariant BuildShaderVariant(unsigned int features)
+{
+  bool hasNormals = (features & Normals) != 0;
+  bool hasTangents = (features & Tangents) != 0;
 
-  using texinfo = std::pair<vtkTexture*, std::string>;
-  std::vector<texinfo> textures = this->GetTextures(actor);
-  hasTangents = hasTangents &&
-    std::find_if(textures.begin(), textures.end(),
-      [](const texinfo& tex) { return tex.second == "normalTex"; }) != textures.end();
+  ShaderVariant variant;
+  std::string& customDecl = variant.CustomDecl;
+  std::string& beginImpl = variant.BeginImpl;
+  std::string& posImpl = variant.PositionImpl;
+  std::string& normalImpl = variant.NormalImpl;
+  customDecl = "//VTK::CustomUniforms::Dec\n";
+  if (features & CompactPositions)
+  {
+    customDecl += "uniform vec3 positionScale;\n"
+                  "uniform vec3 positionShift;\n";
+    posImpl = "  vec4 posMC = vec4(vertexMC.xyz * positionScale + positionShift, 1.0);\n";
+  }
+  else
+  {
+    posImpl = "  vec4 posMC = vertexMC;\n";
+  }
 
-  std::string customDecl = "//VTK::CustomUniforms::Dec\n";
-  std::string beginImpl;
-  std::string posImpl = "  vec4 posMC = vertexMC;\n";
+  // compact normals and tangents are decoded from the octahedron
+  bool compactNormals = hasNormals && (features & CompactNormals) != 0;
+  bool compactTangents = hasTangents && (features & CompactTangents) != 0;
+  if (compactNormals || compactTangents)
+  {
+    customDecl += "vec3 decodeOctahedral(vec2 e)\n"
+                  "{\n"
+                  "  vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n"
+                  "  float t = max(-v.z, 0.0);\n"
+                  "  v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);\n"
+                  "  return normalize(v);\n"
+                  "}\n";
+  }
+  if (features & CompactTCoords)
+  {
+    customDecl += "uniform vec2 tcoordScale;\n"
+                  "uniform vec2 tcoordShift;\n";
+  }
 
   // normals and tangents can be modified by skinnning and morphing in model space
-  std::string normalImpl;
   if (hasNormals)
   {
-    normalImpl += "  normalVCVSOutput = normalMC;\n";
+    normalImpl += compactNormals ? "  normalVCVSOutput = decodeOctahedral(normalMC.xy);\n"
+                                 : "  normalVCVSOutput = normalMC;\n";
   }
   if (hasTangents)
   {
-    normalImpl += "  tangentVCVSOutput = tangentMC;\n";
+    normalImpl += compactTangents ? "  tangentVCVSOutput = decodeOctahedral(tangentMC.xy);\n"
+                                  : "  tangentVCVSOutput = tangentMC;\n";
   }
 
   // morphing
-  vtkUniforms::TupleType type = uniforms->GetUniformTupleType("morphWeights");
-  if (type != vtkUniforms::TupleTypeInvalid)
+  if (features & Morphing)
   {
-    for (int i = 0; i < 4; i++)
-    {
-      std::string name = "target" + std::to_string(i) + "_position";
-
-      // modify position using morph weights
-      if (this->VBOs->GetNumberOfComponents(name.c_str()) == 3)
-      {
-        customDecl += "in vec3 ";
-        customDecl += name;
-        customDecl += ";\n";
-
-        posImpl += " posMC += morphWeights[";
-        posImpl += std::to_string(i);
-        posImpl += "] * vec4(";
-        posImpl += name;
-        posImpl += ", 0);\n";
-      }
-
-      name = "target" + std::to_string(i) + "_normal";
+    customDecl += "uniform samplerBuffer morphTargets;\n"
+                  "uniform int morphTargetsCount;\n"
+                  "uniform int morphTargetsStride;\n";
 
-      // modify normal using morph weights
-      if (this->VBOs->GetNumberOfComponents(name.c_str()) == 3)
-      {
-        customDecl += "in vec3 ";
-        customDecl += name;
-        customDecl += ";\n";
+    // sum the deltas of the targets with a non-zero weight
+    beginImpl += "  vec3 morphPosition = vec3(0.0);\n"
+                 "  vec3 morphNormal = vec3(0.0);\n"
+                 "  int nbTargets = min(morphTargetsCount, morphWeights.length());\n"
+                 "  for (int i = 0; i < nbTargets; i++)\n"
+                 "  {\n"
+                 "    float weight = morphWeights[i];\n"
+                 "    if (weight != 0.0)\n"
+                 "    {\n"
+                 "      int texel = 2 * i * morphTargetsStride + gl_VertexID;\n"
+                 "      morphPosition += weight * texelFetch(morphTargets, texel).xyz;\n";
+    if (hasNormals && (features & MorphNormals))
+    {
+      beginImpl += "      texel += morphTargetsStride;\n"
+                   "      morphNormal += weight * texelFetch(morphTargets, texel).xyz;\n";
+    }
+    beginImpl += "    }\n"
+                 "  }\n";
 
-        if (hasNormals)
-        {
-          normalImpl += " normalVCVSOutput += morphWeights[";
-          normalImpl += std::to_string(i);
-          normalImpl += "] * ";
-          normalImpl += name;
-          normalImpl += ";\n";
-        }
-      }
+    // modify position and normal using morph weights
+    posImpl += "  posMC.xyz += morphPosition;\n";
+    if (hasNormals)
+    {
+      normalImpl += "  normalVCVSOutput += morphNormal;\n";
     }
   }
 
   // skin
-  type = uniforms->GetUniformTupleType("jointMatrices");
-  if (type != vtkUniforms::TupleTypeInvalid)
+  if (features & Skinning)
   {
+    // joint matrices are read from a buffer texture instead of the uniform array
+    // so the number of joints is not limited by the number of uniforms
     customDecl += "in vec4 joints;\n"
-                  "in vec4 weights;\n";
+                  "in vec4 weights;\n"
+                  "uniform samplerBuffer jointPalette;\n"
+                  "mat4 getJointMatrix(float joint)\n"
+                  "{\n"
+                  "  int texel = 4 * int(joint);\n"
+                  "  return mat4(texelFetch(jointPalette, texel),\n"
+                  "              texelFetch(jointPalette, texel + 1),\n"
+                  "              texelFetch(jointPalette, texel + 2),\n"
+                  "              texelFetch(jointPalette, texel + 3));\n"
+                  "}\n";
 
     // compute skinning matrix with current uniform weights
-    beginImpl += "  mat4 skinMat = weights.x * jointMatrices[int(joints.x)]\n"
-                 "               + weights.y * jointMatrices[int(joints.y)]\n"
-                 "               + weights.z * jointMatrices[int(joints.z)]\n"
-                 "               + weights.w * jointMatrices[int(joints.w)];\n";
+    beginImpl += "  mat4 skinMat = weights.x * getJointMatrix(joints.x)\n"
+                 "               + weights.y * getJointMatrix(joints.y)\n"
+                 "               + weights.z * getJointMatrix(joints.z)\n"
+                 "               + weights.w * getJointMatrix(joints.w);\n";
 
     posImpl += "  posMC = skinMat * posMC;\n";
 
@@ -145,12 +283,7 @@ void vtkF3DPolyDataMapper::ReplaceShaderValues(
   }
 
   posImpl += "  gl_Position = MCDCMatrix * posMC;\n";
-
-#if VTK_VERSION_NUMBER >= VTK_VERSION_CHECK(9, 0, 20210506)
-  if (this->PrimitiveInfo[this->LastBoundBO].LastLightComplexity > 0)
-#else
-  if (this->LastLightComplexity[this->LastBoundBO] > 0)
-#endif
+  if (features & VertexVC)
   {
     posImpl += "  vertexVCVSOutput = MCVCMatrix * posMC;\n";
   }
@@ -164,12 +297,780 @@ void vtkF3DPolyDataMapper::ReplaceShaderValues(
     normalImpl += "  tangentVCVSOutput = normalMatrix * tangentVCVSOutput;\n";
   }
 
-  vtkShaderProgram::Substitute(VSSource, "//VTK::CustomUniforms::Dec", customDecl);
-  vtkShaderProgram::Substitute(VSSource, "//VTK::PositionVC::Impl", posImpl);
-  vtkShaderProgram::Substitute(VSSource, "//VTK::Normal::Impl", normalImpl);
-  vtkShaderProgram::Substitute(VSSource, "//VTK::CustomBegin::Impl", beginImpl);
+  return variant;
+}
 
-  vertexShader->SetSource(VSSource);
+//-----------------------------------------------------------------------------
+// Geometry shader computing the screen-space distances of the vertices of each triangle
+// to the opposite edges, interpolated without perspective so that the edges have a constant
+// width in pixels. The VTK tags are replaced by the superclass as for wide lines.
+const char* EdgesGeometryShader = R"(//VTK::System::Dec
+//VTK::PositionVC::Dec
+//VTK::PrimID::Dec
+//VTK::Color::Dec
+//VTK::Normal::Dec
+//VTK::Light::Dec
+//VTK::TCoord::Dec
+//VTK::Picking::Dec
+//VTK::DepthPeeling::Dec
+//VTK::Clip::Dec
+//VTK::Output::Dec
+
+uniform vec2 edgeViewportSize;
+noperspective out vec3 edgeDistance;
+
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 3) out;
+
+void main()
+{
+  vec2 p[3];
+  for (int j = 0; j < 3; j++)
+  {
+    p[j] = 0.5 * edgeViewportSize * gl_in[j].gl_Position.xy / gl_in[j].gl_Position.w;
+  }
+  vec2 e0 = p[2] - p[1];
+  vec2 e1 = p[2] - p[0];
+  vec2 e2 = p[1] - p[0];
+  float area = abs(e1.x * e2.y - e1.y * e2.x);
+  vec3 heights = area / max(vec3(length(e0), length(e1), length(e2)), vec3(1e-6));
+
+  for (int i = 0; i < 3; i++)
+  {
+    //VTK::PrimID::Impl
+    //VTK::Clip::Impl
+    //VTK::Color::Impl
+    //VTK::Normal::Impl
+    //VTK::Light::Impl
+    //VTK::TCoord::Impl
+    //VTK::DepthPeeling::Impl
+    //VTK::Picking::Impl
+    //VTK::PositionVC::Impl
+    edgeDistance = vec3(0.0);
+    edgeDistance[i] = heights[i];
+    gl_Position = gl_in[i].gl_Position;
+    EmitVertex();
+  }
+  EndPrimitive();
+}
+)";
+}
+
+vtkStandardNewMacro(vtkF3DPolyDataMapper);
+vtkInformationKeyMacro(vtkF3DPolyDataMapper, JOINT_PALETTES, ObjectBase);
+
+//-----------------------------------------------------------------------------
+vtkF3DPolyDataMapper::vtkF3DPolyDataMapper()
+{
+  this->SetVBOShiftScaleMethod(vtkOpenGLVertexBufferObject::DISABLE_SHIFT_SCALE);
+
+  // morph targets are not mapped to attributes because OpenGL limits the input attributes
+  // to 16 vectors, they are stored in a buffer texture instead
+  this->MorphTargetsBuffer->SetType(vtkOpenGLBufferObject::TextureBuffer);
+}
+
+//-----------------------------------------------------------------------------
+vtkF3DPolyDataMapper::~vtkF3DPolyDataMapper() = default;
+
+//-----------------------------------------------------------------------------
+void vtkF3DPolyDataMapper::BuildBufferObjects(vtkRenderer* ren, vtkActor* act)
+{
+  this->UpdateVertexAttributes();
+
+  // the morph targets too large for a buffer texture are applied to a copy of the input
+  vtkPolyData* input = this->CurrentInput;
+  vtkSmartPointer<vtkPolyData> morphedInput = this->ApplyMorphTargets(act);
+  if (morphedInput)
+  {
+    this->CurrentInput = morphedInput;
+  }
+
+  // the superclass uploads the quantized positions and the placeholders of the compact
+  // attributes instead of their arrays
+  vtkSmartPointer<vtkPolyData> compactInput = this->BuildCompactAttributes();
+  if (compactInput)
+  {
+    this->CurrentInput = compactInput;
+  }
+  this->Superclass::BuildBufferObjects(ren, act);
+  this->CurrentInput = input;
+
+  // Buffer objects are only rebuilt when the input has been modified,
+  // so the targets are not uploaded again when only the weights change
+  this->BuildMorphTargets(ren);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkF3DPolyDataMapper::GetNeedToRebuildBufferObjects(vtkRenderer* ren, vtkActor* act)
+{
+  // the points morphed on the CPU are uploaded again when the weights change
+  return this->Superclass::GetNeedToRebuildBufferObjects(ren, act) ||
+    (this->CPUMorphing &&
+      act->GetShaderProperty()->GetVertexCustomUniforms()->GetMTime() > this->VBOBuildTime);
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> vtkF3DPolyDataMapper::ApplyMorphTargets(vtkActor* act)
+{
+  vtkPolyData* poly = this->CurrentInput;
+  std::vector<vtkDataArray*> positions;
+  std::vector<vtkDataArray*> normals;
+  if (!poly || !poly->GetPoints() ||
+    !::GetMorphTargets(poly->GetPointData(), positions, normals))
+  {
+    this->CPUMorphing = false;
+    return nullptr;
+  }
+
+  // each target uses two texels per point in the buffer texture
+  GLint maxTexels = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+  vtkIdType nbPoints = poly->GetNumberOfPoints();
+  if (2.0 * nbPoints * positions.size() <= maxTexels)
+  {
+    this->CPUMorphing = false;
+    return nullptr;
+  }
+  if (!this->CPUMorphing)
+  {
+    vtkWarningMacro(<< positions.size() << " morph targets of " << nbPoints
+                    << " points do not fit in a buffer texture of " << maxTexels
+                    << " texels, applying them on the CPU");
+  }
+  this->CPUMorphing = true;
+
+  std::vector<float> weights;
+  act->GetShaderProperty()->GetVertexCustomUniforms()->GetUniform1fv("morphWeights", weights);
+  size_t nbTargets = std::min(weights.size(), positions.size());
+
+  vtkNew<vtkPoints> points;
+  points->DeepCopy(poly->GetPoints());
+  vtkDataArray* inputNormals = poly->GetPointData()->GetNormals();
+  vtkSmartPointer<vtkDataArray> morphedNormals;
+  if (inputNormals && inputNormals->GetNumberOfTuples() == nbPoints &&
+    inputNormals->GetNumberOfComponents() == 3)
+  {
+    morphedNormals = vtkSmartPointer<vtkDataArray>::Take(inputNormals->NewInstance());
+    morphedNormals->DeepCopy(inputNormals);
+  }
+
+  // same sum of the weighted deltas as in the vertex shader
+  auto addDeltas = [&](vtkDataArray* values, vtkDataArray* deltas, float weight) {
+    for (vtkIdType j = 0; j < nbPoints; j++)
+    {
+      double value[3];
+      values->GetTuple(j, value);
+      double* delta = deltas->GetTuple3(j);
+      for (int c = 0; c < 3; c++)
+      {
+        value[c] += weight * delta[c];
+      }
+      values->SetTuple(j, value);
+    }
+  };
+  for (size_t i = 0; i < nbTargets; i++)
+  {
+    if (weights[i] != 0.f)
+    {
+      addDeltas(points->GetData(), positions[i], weights[i]);
+      if (morphedNormals && normals[i])
+      {
+        addDeltas(morphedNormals, normals[i], weights[i]);
+      }
+    }
+  }
+
+  vtkSmartPointer<vtkPolyData> morphedInput = vtkSmartPointer<vtkPolyData>::New();
+  morphedInput->ShallowCopy(poly);
+  morphedInput->SetPoints(points);
+  if (morphedNormals)
+  {
+    morphedInput->GetPointData()->SetNormals(morphedNormals);
+  }
+  return morphedInput;
+}
+
+//-----------------------------------------------------------------------------
+void vtkF3DPolyDataMapper::UpdateVertexAttributes()
+{
+  vtkPolyData* poly = this->CurrentInput;
+  vtkPointData* pointData = poly ? poly->GetPointData() : nullptr;
+  bool haveJoints =
+    pointData && pointData->GetArray("WEIGHTS_0") && pointData->GetArray("JOINTS_0");
+  if (haveJoints == this->HaveJoints)
+  {
+    return;
+  }
+  this->HaveJoints = haveJoints;
+
+  // map glTF arrays to GPU VBOs
+  if (haveJoints)
+  {
+    this->MapDataArrayToVertexAttribute(
+      "weights", "WEIGHTS_0", vtkDataObject::FIELD_ASSOCIATION_POINTS);
+    this->MapDataArrayToVertexAttribute(
+      "joints", "JOINTS_0", vtkDataObject::FIELD_ASSOCIATION_POINTS);
+  }
+  else
+  {
+    this->RemoveVertexAttributeMapping("weights");
+    this->RemoveVertexAttributeMapping("joints");
+  }
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> vtkF3DPolyDataMapper::BuildCompactAttributes()
+{
+  for (auto& it : this->CompactAttributes)
+  {
+    it.second.Buffer->ReleaseGraphicsResources();
+  }
+  this->CompactAttributes.clear();
+  this->CompactPositions = false;
+
+  vtkPolyData* poly = this->CurrentInput;
+  if (!this->CompactVertexBuffers || !poly)
+  {
+    return nullptr;
+  }
+
+  // only the point data attributes with one tuple per point are compacted
+  vtkIdType nbPoints = poly->GetNumberOfPoints();
+  auto isCompactable = [&](vtkDataArray* array, int nbComponents) {
+    return array && array->GetNumberOfTuples() == nbPoints &&
+      array->GetNumberOfComponents() == nbComponents;
+  };
+
+  vtkSmartPointer<vtkPolyData> compactInput = vtkSmartPointer<vtkPolyData>::New();
+  compactInput->ShallowCopy(poly);
+  vtkPointData* pointData = compactInput->GetPointData();
+
+  // the positions are quantized in their bounds, and scaled back in the shader. They stay in the
+  // points uploaded by the superclass, which needs one vertex per point to draw the cells.
+  vtkPoints* points = poly->GetPoints();
+  if (points && nbPoints > 0)
+  {
+    double bounds[6];
+    points->GetBounds(bounds);
+    double scale[3];
+    for (int c = 0; c < 3; c++)
+    {
+      scale[c] = bounds[2 * c + 1] > bounds[2 * c] ? (bounds[2 * c + 1] - bounds[2 * c]) / 65535.0
+                                                   : 1.0;
+      this->PositionShift[c] = static_cast<float>(bounds[2 * c]);
+      this->PositionScale[c] = static_cast<float>(scale[c]);
+    }
+
+    vtkNew<vtkPoints> quantizedPoints;
+    quantizedPoints->SetDataType(VTK_UNSIGNED_SHORT);
+    quantizedPoints->SetNumberOfPoints(nbPoints);
+    unsigned short* quantized = static_cast<unsigned short*>(quantizedPoints->GetVoidPointer(0));
+    for (vtkIdType i = 0; i < nbPoints; i++)
+    {
+      double* point = points->GetPoint(i);
+      for (int c = 0; c < 3; c++)
+      {
+        double value = std::round((point[c] - bounds[2 * c]) / scale[c]);
+        quantized[3 * i + c] = static_cast<unsigned short>(std::min(std::max(value, 0.0), 65535.0));
+      }
+    }
+    compactInput->SetPoints(quantizedPoints);
+    this->CompactPositions = true;
+  }
+
+  for (const char* name : { "normalMC", "tangentMC" })
+  {
+    bool normals = std::string(name) == "normalMC";
+    vtkDataArray* directions = normals ? pointData->GetNormals() : pointData->GetTangents();
+    if (isCompactable(directions, 3))
+    {
+      std::vector<short> encoded(2 * nbPoints);
+      for (vtkIdType i = 0; i < nbPoints; i++)
+      {
+        ::EncodeOctahedral(directions->GetTuple3(i), encoded.data() + 2 * i);
+      }
+      vtkSmartPointer<vtkDataArray> placeholder =
+        this->AddCompactAttribute(name, encoded, VTK_SHORT, 2, true);
+      if (placeholder && normals)
+      {
+        pointData->SetNormals(placeholder);
+      }
+      else if (placeholder)
+      {
+        pointData->SetTangents(placeholder);
+      }
+    }
+  }
+
+  // the texture coordinates are quantized in their range, and scaled back in the shader
+  vtkDataArray* tcoords = pointData->GetTCoords();
+  if (!this->CompactTCoordsFailed && isCompactable(tcoords, 2))
+  {
+    double scale[2];
+    double shift[2];
+    for (int c = 0; c < 2; c++)
+    {
+      double* range = tcoords->GetRange(c);
+      shift[c] = range[0];
+      scale[c] = range[1] > range[0] ? (range[1] - range[0]) / 65535.0 : 1.0;
+      this->TCoordShift[c] = static_cast<float>(shift[c]);
+      this->TCoordScale[c] = static_cast<float>(scale[c]);
+    }
+
+    std::vector<unsigned short> quantized(2 * nbPoints);
+    for (vtkIdType i = 0; i < nbPoints; i++)
+    {
+      double* tcoord = tcoords->GetTuple2(i);
+      for (int c = 0; c < 2; c++)
+      {
+        double value = std::round((tcoord[c] - shift[c]) / scale[c]);
+        quantized[2 * i + c] = static_cast<unsigned short>(std::min(std::max(value, 0.0), 65535.0));
+      }
+    }
+    vtkSmartPointer<vtkDataArray> placeholder =
+      this->AddCompactAttribute("tcoord", quantized, VTK_UNSIGNED_SHORT, 2, false);
+    if (placeholder)
+    {
+      pointData->SetTCoords(placeholder);
+    }
+  }
+
+  return this->CompactAttributes.empty() && !this->CompactPositions ? nullptr : compactInput;
+}
+
+//-----------------------------------------------------------------------------
+template <class T>
+vtkSmartPointer<vtkDataArray> vtkF3DPolyDataMapper::AddCompactAttribute(const std::string& name,
+  const std::vector<T>& data, int dataType, int nbComponents, bool normalize)
+{
+  CompactAttribute attribute;
+  attribute.Buffer = vtkSmartPointer<vtkOpenGLBufferObject>::New();
+  attribute.Buffer->SetType(vtkOpenGLBufferObject::ArrayBuffer);
+  if (!attribute.Buffer->Upload(data, vtkOpenGLBufferObject::ArrayBuffer))
+  {
+    vtkErrorMacro("Cannot upload the compact " << name << " attribute to the GPU");
+    return nullptr;
+  }
+  attribute.DataType = dataType;
+  attribute.NumberOfComponents = nbComponents;
+  attribute.Normalize = normalize;
+  this->CompactAttributes[name] = attribute;
+
+  // the superclass still declares the attribute in its shaders, with its original components,
+  // but only uploads a single value for it
+  vtkSmartPointer<vtkFloatArray> placeholder = vtkSmartPointer<vtkFloatArray>::New();
+  placeholder->SetName(name.c_str());
+  placeholder->SetNumberOfComponents(name == "tcoord" ? 2 : 3);
+  placeholder->SetNumberOfTuples(1);
+  placeholder->Fill(0.0);
+  return placeholder;
+}
+
+//-----------------------------------------------------------------------------
+void vtkF3DPolyDataMapper::BuildMorphTargets(vtkRenderer* ren)
+{
+  this->NumberOfMorphTargets = 0;
+  this->HaveMorphNormals = false;
+
+  vtkPolyData* poly = this->CurrentInput;
+  std::vector<vtkDataArray*> positions;
+  std::vector<vtkDataArray*> normals;
+  if (this->CPUMorphing || !poly || !poly->GetPoints() ||
+    !::GetMorphTargets(poly->GetPointData(), positions, normals))
+  {
+    return;
+  }
+  this->HaveMorphNormals = std::any_of(
+    normals.begin(), normals.end(), [](vtkDataArray* normal) { return normal != nullptr; });
+
+  // the targets are fetched with the vertex index, which is only the point index when the
+  // superclass uploads one vertex per point
+  vtkIdType nbPoints = poly->GetNumberOfPoints();
+  if (this->VBOs->GetNumberOfTuples("vertexMC") != nbPoints)
+  {
+    vtkErrorMacro("Cannot apply " << positions.size()
+                                  << " morph targets, the vertices do not match the points");
+    return;
+  }
+
+  // each texel is a RGBA32F value, the alpha component being unused
+  std::vector<float> targets(8 * nbPoints * positions.size(), 0.f);
+  float* texel = targets.data();
+  for (size_t i = 0; i < positions.size(); i++)
+  {
+    for (vtkDataArray* array : { positions[i], normals[i] })
+    {
+      for (vtkIdType j = 0; j < nbPoints; j++, texel += 4)
+      {
+        if (array)
+        {
+          double* delta = array->GetTuple3(j);
+          texel[0] = static_cast<float>(delta[0]);
+          texel[1] = static_cast<float>(delta[1]);
+          texel[2] = static_cast<float>(delta[2]);
+        }
+      }
+    }
+  }
+
+  this->MorphTargetsTexture->SetContext(
+    static_cast<vtkOpenGLRenderWindow*>(ren->GetRenderWindow()));
+  if (!this->MorphTargetsBuffer->Upload(targets, vtkOpenGLBufferObject::TextureBuffer) ||
+    !this->MorphTargetsTexture->CreateTextureBuffer(static_cast<unsigned int>(targets.size() / 4),
+      4, VTK_FLOAT, this->MorphTargetsBuffer))
+  {
+    vtkErrorMacro("Cannot upload " << positions.size() << " morph targets to the GPU");
+    return;
+  }
+
+  this->NumberOfMorphTargets = static_cast<int>(positions.size());
+}
+
+//-----------------------------------------------------------------------------
+bool vtkF3DPolyDataMapper::DrawingSinglePassEdges(vtkActor* act)
+{
+  return this->EdgeVisibility && act->GetProperty()->GetRepresentation() == VTK_SURFACE &&
+    this->LastBoundBO == &this->Primitives[vtkOpenGLPolyDataMapper::PrimitiveTris];
+}
+
+//-----------------------------------------------------------------------------
+void vtkF3DPolyDataMapper::GetShaderTemplate(
+  std::map<vtkShader::Type, vtkShader*> shaders, vtkRenderer* ren, vtkActor* act)
+{
+  this->Superclass::GetShaderTemplate(shaders, ren, act);
+
+  if (this->DrawingSinglePassEdges(act))
+  {
+    shaders[vtkShader::Geometry]->SetSource(::EdgesGeometryShader);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkF3DPolyDataMapper::SetMapperShaderParameters(
+  vtkOpenGLHelper& cellBO, vtkRenderer* ren, vtkActor* act)
+{
+  vtkMTimeType attributeTime = cellBO.AttributeUpdateTime.GetMTime();
+  this->Superclass::SetMapperShaderParameters(cellBO, ren, act);
+
+  // the superclass binds its placeholders when the VAO or the program changes, so the compact
+  // attributes are bound again only after it did
+  if (cellBO.AttributeUpdateTime.GetMTime() != attributeTime)
+  {
+    for (auto& it : this->CompactAttributes)
+    {
+      const CompactAttribute& attribute = it.second;
+      if (cellBO.Program->IsAttributeUsed(it.first.c_str()))
+      {
+        cellBO.VAO->AddAttributeArray(cellBO.Program, attribute.Buffer, it.first, 0,
+          attribute.NumberOfComponents * vtkDataArray::GetDataTypeSize(attribute.DataType),
+          attribute.DataType, attribute.NumberOfComponents, attribute.Normalize);
+      }
+    }
+  }
+  if (cellBO.Program->IsUniformUsed("positionScale"))
+  {
+    cellBO.Program->SetUniform3f("positionScale", this->PositionScale);
+    cellBO.Program->SetUniform3f("positionShift", this->PositionShift);
+  }
+  if (cellBO.Program->IsUniformUsed("tcoordScale"))
+  {
+    cellBO.Program->SetUniform2f("tcoordScale", this->TCoordScale);
+    cellBO.Program->SetUniform2f("tcoordShift", this->TCoordShift);
+  }
+
+  if (cellBO.Program->IsUniformUsed("edgeViewportSize"))
+  {
+    int width;
+    int height;
+    int origin[2];
+    ren->GetTiledSizeAndOrigin(&width, &height, &origin[0], &origin[1]);
+    float viewportSize[2] = { static_cast<float>(width), static_cast<float>(height) };
+    cellBO.Program->SetUniform2f("edgeViewportSize", viewportSize);
+
+    vtkProperty* prop = act->GetProperty();
+    double* color = prop->GetEdgeColor();
+    float edgeColor[3] = { static_cast<float>(color[0]), static_cast<float>(color[1]),
+      static_cast<float>(color[2]) };
+    cellBO.Program->SetUniform3f("edgeColor", edgeColor);
+    cellBO.Program->SetUniformf("edgeWidth", prop->GetLineWidth());
+  }
+
+  if (this->NumberOfMorphTargets > 0 && cellBO.Program->IsUniformUsed("morphTargets"))
+  {
+    this->MorphTargetsTexture->Activate();
+    cellBO.Program->SetUniformi("morphTargets", this->MorphTargetsTexture->GetTextureUnit());
+    cellBO.Program->SetUniformi("morphTargetsCount", this->NumberOfMorphTargets);
+    cellBO.Program->SetUniformi(
+      "morphTargetsStride", static_cast<int>(this->CurrentInput->GetNumberOfPoints()));
+  }
+
+  if (cellBO.Program->IsUniformUsed("jointPalette"))
+  {
+    this->UpdateJointPalette(ren, act);
+    if (this->CurrentJointPalette)
+    {
+      this->CurrentJointPalette->Texture->Activate();
+      cellBO.Program->SetUniformi(
+        "jointPalette", this->CurrentJointPalette->Texture->GetTextureUnit());
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkF3DPolyDataMapper::UpdateJointPalette(vtkRenderer* ren, vtkActor* act)
+{
+  vtkUniforms* uniforms = act->GetShaderProperty()->GetVertexCustomUniforms();
+  if (this->CurrentJointPalette && uniforms->GetMTime() <= this->JointPaletteTime)
+  {
+    return;
+  }
+  this->JointPaletteTime = uniforms->GetMTime();
+
+  std::vector<float> matrices;
+  if (!uniforms->GetUniformMatrix4x4v("jointMatrices", matrices) || matrices.empty())
+  {
+    this->ReleaseJointPalette(ren->GetRenderWindow());
+    return;
+  }
+
+  if (this->CurrentJointPalette && this->CurrentJointPalette->Matrices == matrices)
+  {
+    return;
+  }
+
+  vtkInformation* info = ren->GetInformation();
+  vtkF3DJointPaletteCache* cache =
+    vtkF3DJointPaletteCache::SafeDownCast(info->Get(vtkF3DPolyDataMapper::JOINT_PALETTES()));
+  if (!cache)
+  {
+    vtkNew<vtkF3DJointPaletteCache> newCache;
+    info->Set(vtkF3DPolyDataMapper::JOINT_PALETTES(), newCache);
+    cache = newCache;
+  }
+
+  vtkRenderWindow* renWin = ren->GetRenderWindow();
+  size_t key = ::HashMatrices(matrices);
+  std::shared_ptr<vtkF3DJointPalette> palette = cache->Palettes[key].lock();
+  if (!palette || palette->Matrices != matrices)
+  {
+    // another mapper has not uploaded these matrices yet
+    palette = std::make_shared<vtkF3DJointPalette>();
+    palette->Buffer->SetType(vtkOpenGLBufferObject::TextureBuffer);
+    palette->Texture->SetContext(static_cast<vtkOpenGLRenderWindow*>(renWin));
+
+    // each matrix is stored as 4 RGBA32F texels, one per column
+    if (!palette->Buffer->Upload(matrices, vtkOpenGLBufferObject::TextureBuffer) ||
+      !palette->Texture->CreateTextureBuffer(
+        static_cast<unsigned int>(matrices.size() / 4), 4, VTK_FLOAT, palette->Buffer))
+    {
+      vtkErrorMacro("Cannot upload " << matrices.size() / 16 << " joint matrices to the GPU");
+      palette->ReleaseGraphicsResources(renWin);
+      this->ReleaseJointPalette(renWin);
+      return;
+    }
+    palette->Matrices = std::move(matrices);
+    cache->Palettes[key] = palette;
+  }
+
+  this->ReleaseJointPalette(renWin);
+  this->CurrentJointPalette = palette;
+
+  // purge the palettes of previous frames
+  for (auto it = cache->Palettes.begin(); it != cache->Palettes.end();)
+  {
+    it = it->second.expired() ? cache->Palettes.erase(it) : std::next(it);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkF3DPolyDataMapper::ReleaseJointPalette(vtkWindow* win)
+{
+  // the context is current here, unlike when the last reference is dropped elsewhere
+  if (this->CurrentJointPalette && this->CurrentJointPalette.use_count() == 1)
+  {
+    this->CurrentJointPalette->ReleaseGraphicsResources(win);
+  }
+  this->CurrentJointPalette = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+void vtkF3DPolyDataMapper::RenderPieceFinish(vtkRenderer* ren, vtkActor* act)
+{
+  if (this->NumberOfMorphTargets > 0)
+  {
+    this->MorphTargetsTexture->Deactivate();
+  }
+  if (this->CurrentJointPalette)
+  {
+    this->CurrentJointPalette->Texture->Deactivate();
+  }
+
+  this->Superclass::RenderPieceFinish(ren, act);
+}
+
+//-----------------------------------------------------------------------------
+void vtkF3DPolyDataMapper::ReleaseGraphicsResources(vtkWindow* win)
+{
+  this->MorphTargetsTexture->ReleaseGraphicsResources(win);
+  this->MorphTargetsBuffer->ReleaseGraphicsResources();
+  this->ReleaseJointPalette(win);
+  this->JointPaletteTime = 0;
+  for (auto& it : this->CompactAttributes)
+  {
+    it.second.Buffer->ReleaseGraphicsResources();
+  }
+  this->CompactAttributes.clear();
+  this->CompactPositions = false;
+
+  this->Superclass::ReleaseGraphicsResources(win);
+}
+
+//-----------------------------------------------------------------------------
+void vtkF3DPolyDataMapper::ReplaceShaderValues(
+  std::map<vtkShader::Type, vtkShader*> shaders, vtkRenderer* ren, vtkActor* actor)
+{
+  // static meshes keep the shaders of the superclass, others use the variant of their features
+  auto vertexShader = shaders[vtkShader::Vertex];
+  unsigned int features = this->GetShaderFeatures(actor);
+  if ((features & ~::PlainFeatures) != 0)
+  {
+    auto it = ::ShaderVariants.find(features);
+    if (it == ::ShaderVariants.end())
+    {
+      it = ::ShaderVariants.emplace(features, ::BuildShaderVariant(features)).first;
+    }
+    const ::ShaderVariant& variant = it->second;
+
+    auto VSSource = vertexShader->GetSource();
+    vtkShaderProgram::Substitute(VSSource, "//VTK::CustomUniforms::Dec", variant.CustomDecl);
+    vtkShaderProgram::Substitute(VSSource, "//VTK::PositionVC::Impl", variant.PositionImpl);
+    vtkShaderProgram::Substitute(VSSource, "//VTK::Normal::Impl", variant.NormalImpl);
+    vtkShaderProgram::Substitute(VSSource, "//VTK::CustomBegin::Impl", variant.BeginImpl);
+    vertexShader->SetSource(VSSource);
+  }
+
+  // the edges are blended once the fragment color is computed, including the textures
+  bool drawingEdges = this->DrawingSinglePassEdges(actor);
+  auto fragmentShader = shaders[vtkShader::Fragment];
+  if (drawingEdges)
+  {
+    auto FSSource = fragmentShader->GetSource();
+    vtkShaderProgram::Substitute(FSSource, "//VTK::Output::Dec",
+      "//VTK::Output::Dec\n"
+      "uniform vec3 edgeColor;\n"
+      "uniform float edgeWidth;\n"
+      "noperspective in vec3 edgeDistance;\n");
+    vtkShaderProgram::Substitute(
+      FSSource, "//VTK::TCoord::Impl", "//VTK::TCoord::Impl\n  //VTK::F3DEdges::Impl");
+    fragmentShader->SetSource(FSSource);
+  }
 
   this->Superclass::ReplaceShaderValues(shaders, ren, actor);
+
+  if (drawingEdges)
+  {
+    auto FSSource = fragmentShader->GetSource();
+    vtkShaderProgram::Substitute(FSSource, "//VTK::F3DEdges::Impl",
+      "float edgeNearest = min(min(edgeDistance.x, edgeDistance.y), edgeDistance.z);\n"
+      "  float edgeFactor =\n"
+      "    smoothstep(0.5 * edgeWidth - 0.5, 0.5 * edgeWidth + 0.5, edgeNearest);\n"
+      "  gl_FragData[0].rgb = mix(edgeColor, gl_FragData[0].rgb, edgeFactor);\n");
+    fragmentShader->SetSource(FSSource);
+  }
+
+  if ((features & (::Skinning | ::CompactTCoords)) == 0)
+  {
+    return;
+  }
+
+  auto VSSource = vertexShader->GetSource();
+  if (features & ::Skinning)
+  {
+    // the joint matrices custom uniform is not needed by the shader anymore, removing its
+    // declaration also prevents the palette from being sent as uniforms for every draw
+    size_t declaration = VSSource.find("uniform mat4 jointMatrices[");
+    if (declaration != std::string::npos)
+    {
+      VSSource.erase(declaration, VSSource.find(';', declaration) + 1 - declaration);
+    }
+  }
+  if ((features & ::CompactTCoords) &&
+    !vtkShaderProgram::Substitute(VSSource, "tcoordVCVSOutput = tcoord;",
+      "tcoordVCVSOutput = tcoord * tcoordScale + tcoordShift;"))
+  {
+    // the float texture coordinates are uploaded again at the next render
+    vtkErrorMacro("Cannot decode the compact texture coordinates in the vertex shader, "
+                  "uploading them as floats");
+    this->CompactTCoordsFailed = true;
+    this->Modified();
+  }
+  vertexShader->SetSource(VSSource);
+}
+
+//-----------------------------------------------------------------------------
+unsigned int vtkF3DPolyDataMapper::GetShaderFeatures(vtkActor* actor)
+{
+  unsigned int features = 0;
+  bool lighting = actor->GetProperty()->GetLighting();
+  if (lighting && this->VBOs->GetNumberOfComponents("normalMC") == 3)
+  {
+    features |= ::Normals;
+    if (this->CompactAttributes.count("normalMC") > 0)
+    {
+      features |= ::CompactNormals;
+    }
+  }
+
+  // the tangents are only used with a normal texture
+  if (lighting && this->VBOs->GetNumberOfComponents("tangentMC") == 3)
+  {
+    std::vector<std::pair<vtkTexture*, std::string> > textures = this->GetTextures(actor);
+    if (std::any_of(textures.begin(), textures.end(),
+          [](const std::pair<vtkTexture*, std::string>& tex) { return tex.second == "normalTex"; }))
+    {
+      features |= ::Tangents;
+      if (this->CompactAttributes.count("tangentMC") > 0)
+      {
+        features |= ::CompactTangents;
+      }
+    }
+  }
+
+  if (this->CompactAttributes.count("tcoord") > 0)
+  {
+    features |= ::CompactTCoords;
+  }
+
+  if (this->CompactPositions)
+  {
+    features |= ::CompactPositions;
+  }
+
+  vtkUniforms* uniforms = actor->GetShaderProperty()->GetVertexCustomUniforms();
+  if (this->NumberOfMorphTargets > 0 &&
+    uniforms->GetUniformTupleType("morphWeights") != vtkUniforms::TupleTypeInvalid)
+  {
+    features |= ::Morphing;
+    if (this->HaveMorphNormals)
+    {
+      features |= ::MorphNormals;
+    }
+  }
+
+  if (this->HaveJoints &&
+    uniforms->GetUniformTupleType("jointMatrices") != vtkUniforms::TupleTypeInvalid)
+  {
+    features |= ::Skinning;
+  }
+
+#if VTK_VERSION_NUMBER >= VTK_VERSION_CHECK(9, 0, 20210506)
+  if (this->PrimitiveInfo[this->LastBoundBO].LastLightComplexity > 0)
+#else
+  if (this->LastLightComplexity[this->LastBoundBO] > 0)
+#endif
+  {
+    features |= ::VertexVC;
+  }
+
+  return features;
 }
@@ -2,12 +2,29 @@
  * @class   vtkF3DPolyDataMapper
  * @brief   Custom surface mapper used to include skinning and morphing for glTF format
  *
+ * It can also draw the edges of the triangles in the same pass as the surface, using a
+ * geometry shader computing the screen-space distance of each fragment to the edges, and
+ * upload the normals, tangents and texture coordinates in a compact format.
  */
 
 #ifndef vtkF3DPolyDataMapper_h
 #define vtkF3DPolyDataMapper_h
 
+#include <vtkNew.h>
 #include <vtkOpenGLPolyDataMapper.h>
+#include <vtkSmartPointer.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class vtkDataArray;
+class vtkInformationObjectBaseKey;
+class vtkOpenGLBufferObject;
+class vtkPolyData;
+class vtkTextureObject;
+struct vtkF3DJointPalette;
 
 class vtkF3DPolyDataMapper : public vtkOpenGLPolyDataMapper
 {
@@ -15,17 +32,171 @@ public:
   static vtkF3DPolyDataMapper* New();
   vtkTypeMacro(vtkF3DPolyDataMapper, vtkOpenGLPolyDataMapper);
 
+  //@{
+  /**
+   * Set/Get the visibility of the edges drawn in the same pass as the triangles.
+   * The edges use the edge color and the line width of the actor property, in pixels.
+   * Unlike the edge visibility of the property, it does not need another draw of the
+   * geometry nor a coincident topology offset, but polygons show the edges of their
+   * triangulation. Default is false.
+   */
+  vtkSetMacro(EdgeVisibility, bool);
+  vtkGetMacro(EdgeVisibility, bool);
+  vtkBooleanMacro(EdgeVisibility, bool);
+  //@}
+
+  //@{
+  /**
+   * Set/Get if the vertex attributes are uploaded in a compact format decoded by the vertex
+   * shader: 16-bit positions and texture coordinates quantized in their bounds, and 16-bit
+   * octahedral normals and tangents. This divides their GPU memory by 2 and 3. The indices
+   * stay in 32 bits since the index buffers and the draw calls of the superclass cannot be
+   * changed from here. Default is false.
+   */
+  vtkSetMacro(CompactVertexBuffers, bool);
+  vtkGetMacro(CompactVertexBuffers, bool);
+  vtkBooleanMacro(CompactVertexBuffers, bool);
+  //@}
+
   /**
-   * Modify the shaders to include skinning and morphing capabilities
+   * Use a geometry shader computing the distances to the edges when drawing them
+   */
+  void GetShaderTemplate(
+    std::map<vtkShader::Type, vtkShader*> shaders, vtkRenderer* ren, vtkActor* act) override;
+
+  /**
+   * Modify the shaders to include skinning and morphing capabilities.
+   * The vertex shader code is generated once for each combination of features, and the
+   * shaders of static meshes are left to the superclass.
    */
   void ReplaceShaderValues(
     std::map<vtkShader::Type, vtkShader*> shaders, vtkRenderer* ren, vtkActor* actor) override;
 
+  /**
+   * Bind the morph targets and joint palette buffer textures, the compact attributes,
+   * and set the edges uniforms
+   */
+  void SetMapperShaderParameters(vtkOpenGLHelper& cellBO, vtkRenderer* ren, vtkActor* act) override;
+
+  /**
+   * Release the morph targets and joint palette buffer textures and the compact attributes
+   */
+  void ReleaseGraphicsResources(vtkWindow* win) override;
+
+  /**
+   * Key of the renderer information storing the joint palettes shared by its mappers
+   */
+  static vtkInformationObjectBaseKey* JOINT_PALETTES();
+
 protected:
   vtkF3DPolyDataMapper();
-  ~vtkF3DPolyDataMapper() override = default;
+  ~vtkF3DPolyDataMapper() override;
+
+  /**
+   * Upload the morph targets and the compact attributes along with the other buffer objects
+   */
+  void BuildBufferObjects(vtkRenderer* ren, vtkActor* act) override;
+
+  /**
+   * Also rebuild the buffer objects when the morph weights applied on the CPU change
+   */
+  bool GetNeedToRebuildBufferObjects(vtkRenderer* ren, vtkActor* act) override;
+
+  /**
+   * Map the glTF skinning arrays to vertex attributes only when the input has them,
+   * so that other meshes do not look for them when uploading their buffer objects
+   */
+  void UpdateVertexAttributes();
+
+  /**
+   * Get the features of the vertex shader needed to render the current input with the actor,
+   * as a combination of bits
+   */
+  unsigned int GetShaderFeatures(vtkActor* actor);
+
+  /**
+   * Unbind the morph targets and joint palette buffer textures
+   */
+  void RenderPieceFinish(vtkRenderer* ren, vtkActor* act) override;
+
+  /**
+   * Pack all the targetN_position and targetN_normal arrays of the input into a buffer texture.
+   * For each target, N points positions deltas are followed by N points normals deltas,
+   * so the vertex shader can fetch them using the vertex index. The targets are not used
+   * when the superclass does not upload one vertex per point.
+   */
+  void BuildMorphTargets(vtkRenderer* ren);
+
+  /**
+   * When the morph targets of the input do not fit in a buffer texture, warn and return a
+   * shallow copy of the input whose points and normals are morphed with the "morphWeights"
+   * custom uniform of the actor. Return nullptr when the targets are applied on the GPU.
+   */
+  vtkSmartPointer<vtkPolyData> ApplyMorphTargets(vtkActor* act);
+
+  /**
+   * Upload the compact normals, tangents and texture coordinates of the input.
+   * Return a shallow copy of the input where they are replaced by a single value, to be
+   * uploaded by the superclass so that its shaders are unchanged without uploading the full
+   * float arrays, or nullptr if no attribute is compact.
+   */
+  vtkSmartPointer<vtkPolyData> BuildCompactAttributes();
+
+  /**
+   * Upload a compact attribute and return the single value placeholder replacing the array
+   * uploaded by the superclass, nullptr if the upload failed
+   */
+  template <class T>
+  vtkSmartPointer<vtkDataArray> AddCompactAttribute(const std::string& name,
+    const std::vector<T>& data, int dataType, int nbComponents, bool normalize);
+
+  /**
+   * Make sure the joint palette buffer texture contains the "jointMatrices" custom uniform
+   * of the actor. Palettes are shared between all the mappers of the renderer using the same
+   * joint matrices, so a skeleton deforming several meshes is uploaded only once per frame.
+   */
+  void UpdateJointPalette(vtkRenderer* ren, vtkActor* act);
+
+  /**
+   * Stop using the current joint palette, releasing its graphics resources if no other
+   * mapper uses it. The context of the window must be current.
+   */
+  void ReleaseJointPalette(vtkWindow* win);
+
+  /**
+   * Return true if the edges are drawn in the same pass as the currently bound primitives
+   */
+  bool DrawingSinglePassEdges(vtkActor* act);
+
+  bool EdgeVisibility = false;
+
+  struct CompactAttribute
+  {
+    vtkSmartPointer<vtkOpenGLBufferObject> Buffer;
+    int DataType;
+    int NumberOfComponents;
+    bool Normalize;
+  };
+
+  bool CompactVertexBuffers = false;
+  std::map<std::string, CompactAttribute> CompactAttributes;
+  bool CompactPositions = false;
+  float PositionScale[3] = { 1.f, 1.f, 1.f };
+  float PositionShift[3] = { 0.f, 0.f, 0.f };
+  float TCoordScale[2] = { 1.f, 1.f };
+  float TCoordShift[2] = { 0.f, 0.f };
+  bool CompactTCoordsFailed = false;
 
   bool HaveJoints = false;
+
+  bool CPUMorphing = false;
+  int NumberOfMorphTargets = 0;
+  bool HaveMorphNormals = false;
+  vtkNew<vtkOpenGLBufferObject> MorphTargetsBuffer;
+  vtkNew<vtkTextureObject> MorphTargetsTexture;
+
+  std::shared_ptr<vtkF3DJointPalette> CurrentJointPalette;
+  vtkMTimeType JointPaletteTime = 0;
 };
 
 #endif
@@ -1,7 +1,14 @@
 #include "vtkF3DRenderPass.h"
 
 #include "Config.h"
-
+#include "vtkF3DCuller.h"
+#include "vtkF3DDepthPrepass.h"
+#include "vtkF3DGPUProfiler.h"
+#include "vtkF3DOcclusionQueryPass.h"
+#include "vtkF3DSSAOPass.h"
+#include "vtkF3DTimestampPass.h"
+
+#include <vtkActor.h>
 #include <vtkBoundingBox.h>
 #include <vtkCameraPass.h>
 #include <vtkDualDepthPeelingPass.h>
@@ -9,6 +16,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkOpaquePass.h>
 #include <vtkOpenGLFXAAPass.h>
+#include <vtkOrderIndependentTranslucentPass.h>
 #include <vtkOpenGLRenderUtilities.h>
 #include <vtkOpenGLRenderWindow.h>
 #include <vtkOpenGLShaderCache.h>
@@ -32,16 +40,71 @@
 #include <vtkOSPRayPass.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 
 vtkStandardNewMacro(vtkF3DRenderPass);
 
+// ----------------------------------------------------------------------------
+vtkF3DRenderPass::~vtkF3DRenderPass() = default;
+
 // ----------------------------------------------------------------------------
 void vtkF3DRenderPass::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
 }
 
+// ----------------------------------------------------------------------------
+vtkMTimeType vtkF3DRenderPass::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  mTime = std::max(mTime, this->FramebufferConfigTime.GetMTime());
+  return std::max(mTime, this->BlendConfigTime.GetMTime());
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DRenderPass::SetUseHighDynamicRange(bool use)
+{
+  if (this->UseHighDynamicRange != use)
+  {
+    this->UseHighDynamicRange = use;
+    this->FramebufferConfigTime.Modified();
+  }
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DRenderPass::SetUseToneMapping(bool use)
+{
+  if (this->UseToneMapping != use)
+  {
+    this->UseToneMapping = use;
+    this->FramebufferConfigTime.Modified();
+    this->BlendConfigTime.Modified();
+  }
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DRenderPass::SetUseFXAA(bool use)
+{
+  if (this->UseFXAA != use)
+  {
+    this->UseFXAA = use;
+    this->FramebufferConfigTime.Modified();
+    this->BlendConfigTime.Modified();
+  }
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DRenderPass::SetUseBlurBackground(bool use)
+{
+  if (this->UseBlurBackground != use)
+  {
+    this->UseBlurBackground = use;
+    this->BlendConfigTime.Modified();
+  }
+}
+
 // ----------------------------------------------------------------------------
 void vtkF3DRenderPass::ReleaseGraphicsResources(vtkWindow* w)
 {
@@ -57,21 +120,18 @@ void vtkF3DRenderPass::ReleaseGraphicsResources(vtkWindow* w)
   {
     this->MainPass->ReleaseGraphicsResources(w);
   }
+  if (this->MainDelegatePass)
+  {
+    this->MainDelegatePass->ReleaseGraphicsResources(w);
+  }
 }
 
 // ----------------------------------------------------------------------------
-void vtkF3DRenderPass::Initialize(const vtkRenderState* s)
+void vtkF3DRenderPass::SortProps(const vtkRenderState* s)
 {
-  if (this->InitializeTime == this->MTime)
-  {
-    // already initialized
-    return;
-  }
-
-  this->ReleaseGraphicsResources(s->GetRenderer()->GetRenderWindow());
-
   this->BackgroundProps.clear();
   this->MainProps.clear();
+  this->OpaqueMainProps = true;
 
   // assign props to the correct pass
   vtkProp** props = s->GetPropArray();
@@ -85,25 +145,63 @@ void vtkF3DRenderPass::Initialize(const vtkRenderState* s)
     else
     {
       this->MainProps.push_back(prop);
+
+      // translucent, volumic and 2D props are blended with the content of the render target
+      vtkActor* actor = vtkActor::SafeDownCast(prop);
+      if (prop->GetVisibility() && (!actor || actor->HasTranslucentPolygonalGeometry()))
+      {
+        this->OpaqueMainProps = false;
+      }
     }
   }
+}
 
-  // background pass, setup framebuffer, clear and draw skybox
-  vtkNew<vtkOpaquePass> bgP;
-  vtkNew<vtkCameraPass> bgCamP;
-  bgCamP->SetDelegatePass(bgP);
-  this->BackgroundPass = vtkSmartPointer<vtkFramebufferPass>::New();
-  this->BackgroundPass->SetDelegatePass(bgCamP);
-  this->BackgroundPass->SetColorFormat(vtkTextureObject::Float32);
+// ----------------------------------------------------------------------------
+void vtkF3DRenderPass::Initialize(const vtkRenderState* s)
+{
+  vtkRenderWindow* renWin = s->GetRenderer()->GetRenderWindow();
+
+  // The scene is rendered over a background texture, then blended with it, unless the result
+  // would be the same when rendering it directly: a translucent color is blended with the cleared
+  // background a first time by the passes, and a second time by the blend shader.
+  // The passes below also composite their result with the content of the render target.
+  bool opaque = this->OpaqueMainProps && !this->UseRaytracing && !this->UseSSAOPass &&
+    !this->UseDepthPeelingPass && !this->UseWeightedBlendingPass;
+  bool hasBackground = !this->BackgroundProps.empty() || !opaque;
+  if (this->MainDelegatePass && this->PassesBuildTime > this->MTime)
+  {
+    this->InitializeFramebuffers(renWin, hasBackground, opaque);
+    return;
+  }
+
+  // only the passes rendering the scene are released, the render targets are kept
+  if (this->MainDelegatePass)
+  {
+    if (this->MainPass)
+    {
+      this->MainPass->SetDelegatePass(nullptr);
+    }
+    this->MainDelegatePass->ReleaseGraphicsResources(renWin);
+  }
+
+  this->SSAOPass = nullptr;
+  this->DepthPrepass = nullptr;
+
+  // the end of each pass is marked when the frame is profiled
+  auto timed = [this](vtkRenderPass* pass, const char* section) {
+    vtkSmartPointer<vtkF3DTimestampPass> timestampP = vtkSmartPointer<vtkF3DTimestampPass>::New();
+    timestampP->SetDelegatePass(pass);
+    timestampP->SetProfiler(this->Profiler);
+    timestampP->SetSection(section);
+    return timestampP;
+  };
 
   // main pass
   if (F3D_MODULE_RAYTRACING && this->UseRaytracing)
   {
 #if F3D_MODULE_RAYTRACING
     vtkNew<vtkOSPRayPass> ospP;
-    this->MainPass = vtkSmartPointer<vtkFramebufferPass>::New();
-    this->MainPass->SetDelegatePass(ospP);
-    this->MainPass->SetColorFormat(vtkTextureObject::Float32);
+    this->MainDelegatePass = timed(ospP, "Raytracing");
 #endif
   }
   else
@@ -117,6 +215,15 @@ void vtkF3DRenderPass::Initialize(const vtkRenderState* s)
     vtkNew<vtkRenderPassCollection> collection;
     collection->AddItem(lightsP);
 
+    // the opaque geometry is optionally rendered twice, its depth first
+    vtkSmartPointer<vtkRenderPass> opaqueGeometryP = opaqueP.Get();
+    if (this->UseDepthPrepass)
+    {
+      this->DepthPrepass = vtkSmartPointer<vtkF3DDepthPrepass>::New();
+      this->DepthPrepass->SetDelegatePass(opaqueP);
+      opaqueGeometryP = this->DepthPrepass;
+    }
+
     // opaque passes
     if (this->UseSSAOPass)
     {
@@ -124,24 +231,50 @@ void vtkF3DRenderPass::Initialize(const vtkRenderState* s)
       if (bbox.IsValid())
       {
         vtkNew<vtkCameraPass> ssaoCamP;
-        ssaoCamP->SetDelegatePass(opaqueP);
-
-        vtkNew<vtkSSAOPass> ssaoP;
-        ssaoP->SetRadius(0.1 * bbox.GetDiagonalLength());
-        ssaoP->SetBias(0.001 * bbox.GetDiagonalLength());
-        ssaoP->SetKernelSize(200);
-        ssaoP->SetDelegatePass(ssaoCamP);
-
-        collection->AddItem(ssaoP);
+        ssaoCamP->SetDelegatePass(opaqueGeometryP);
+
+        if (this->SSAOResolution < 1.0)
+        {
+          // reduced resolution, with a smaller kernel while interacting
+          vtkNew<vtkF3DSSAOPass> ssaoP;
+          ssaoP->SetRadius(0.1 * bbox.GetDiagonalLength());
+          ssaoP->SetBias(0.001 * bbox.GetDiagonalLength());
+          ssaoP->SetKernelSize(this->SSAOKernelSize);
+          ssaoP->SetInteractiveKernelSize(std::max(8, this->SSAOKernelSize / 4));
+          ssaoP->SetResolutionScale(this->SSAOResolution);
+          ssaoP->SetInteractive(this->Interactive);
+          ssaoP->SetDelegatePass(ssaoCamP);
+          this->SSAOPass = ssaoP;
+
+          collection->AddItem(timed(ssaoP, "Opaque and SSAO"));
+        }
+        else
+        {
+          vtkNew<vtkSSAOPass> ssaoP;
+          ssaoP->SetRadius(0.1 * bbox.GetDiagonalLength());
+          ssaoP->SetBias(0.001 * bbox.GetDiagonalLength());
+          ssaoP->SetKernelSize(this->SSAOKernelSize);
+          ssaoP->SetDelegatePass(ssaoCamP);
+
+          collection->AddItem(timed(ssaoP, "Opaque and SSAO"));
+        }
       }
       else
       {
-        collection->AddItem(opaqueP);
+        collection->AddItem(timed(opaqueGeometryP, "Opaque"));
       }
     }
     else
     {
-      collection->AddItem(opaqueP);
+      collection->AddItem(timed(opaqueGeometryP, "Opaque"));
+    }
+
+    // the visibility of the props is tested against the depth of the opaque geometry
+    if (this->Culler && this->Culler->GetOcclusionCulling())
+    {
+      vtkNew<vtkF3DOcclusionQueryPass> occlusionP;
+      occlusionP->SetCuller(this->Culler);
+      collection->AddItem(timed(occlusionP, "Occlusion queries"));
     }
 
     // translucent and volumic passes
@@ -150,43 +283,177 @@ void vtkF3DRenderPass::Initialize(const vtkRenderState* s)
       vtkNew<vtkDualDepthPeelingPass> ddpP;
       ddpP->SetTranslucentPass(translucentP);
       ddpP->SetVolumetricPass(volumeP);
-      collection->AddItem(ddpP);
+      collection->AddItem(timed(ddpP, "Depth peeling"));
+    }
+    else if (this->UseWeightedBlendingPass)
+    {
+      vtkNew<vtkOrderIndependentTranslucentPass> oitP;
+      oitP->SetTranslucentPass(translucentP);
+      collection->AddItem(timed(oitP, "Weighted blending"));
+      collection->AddItem(timed(volumeP, "Volume"));
     }
     else
     {
-      collection->AddItem(translucentP);
-      collection->AddItem(volumeP);
+      collection->AddItem(timed(translucentP, "Translucent"));
+      collection->AddItem(timed(volumeP, "Volume"));
     }
 
-    collection->AddItem(overlayP);
+    collection->AddItem(timed(overlayP, "Overlay"));
 
     vtkNew<vtkSequencePass> sequence;
     sequence->SetPasses(collection);
 
     vtkNew<vtkCameraPass> camP;
     camP->SetDelegatePass(sequence);
+    this->MainDelegatePass = camP;
+  }
+
+  this->PassesBuildTime.Modified();
+
+  this->InitializeFramebuffers(renWin, hasBackground, opaque);
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DRenderPass::InitializeFramebuffers(
+  vtkRenderWindow* renWin, bool hasBackground, bool opaque)
+{
+  if (this->FramebuffersBuildTime > this->FramebufferConfigTime &&
+    this->InitializedWithBackground == hasBackground && this->InitializedOpaque == opaque)
+  {
+    // the passes rendering the scene may have been rebuilt
+    if (this->MainPass)
+    {
+      this->MainPass->SetDelegatePass(this->MainDelegatePass);
+    }
+    return;
+  }
+
+  if (this->BackgroundPass)
+  {
+    this->BackgroundPass->ReleaseGraphicsResources(renWin);
+  }
+  if (this->MainPass)
+  {
+    // the passes rendering the scene would be released along with the framebuffer pass
+    this->MainPass->SetDelegatePass(nullptr);
+    this->MainPass->ReleaseGraphicsResources(renWin);
+  }
 
+  // half float targets are only needed when the colors can exceed 1, but the translucent
+  // colors keep full precision since they are rounded again when blended with the background
+  int colorFormat = vtkTextureObject::Float32;
+  if (opaque)
+  {
+    colorFormat = this->UseHighDynamicRange ? vtkTextureObject::Float16 : vtkTextureObject::Fixed8;
+  }
+
+  // background pass, setup framebuffer, clear and draw skybox if any
+  this->BackgroundPass = nullptr;
+  this->MainPass = nullptr;
+  if (hasBackground)
+  {
+    vtkNew<vtkOpaquePass> bgP;
+    vtkNew<vtkCameraPass> bgCamP;
+    bgCamP->SetDelegatePass(bgP);
+    this->BackgroundPass = vtkSmartPointer<vtkFramebufferPass>::New();
+    this->BackgroundPass->SetDelegatePass(bgCamP);
+    this->BackgroundPass->SetColorFormat(colorFormat);
+  }
+
+  // the main pass is rendered into a texture when it has to be post processed
+  if (this->BackgroundPass || this->UseToneMapping || this->UseFXAA)
+  {
     this->MainPass = vtkSmartPointer<vtkFramebufferPass>::New();
-    this->MainPass->SetDelegatePass(camP);
-    this->MainPass->SetColorFormat(vtkTextureObject::Float32);
+    this->MainPass->SetDelegatePass(this->MainDelegatePass);
+    this->MainPass->SetColorFormat(colorFormat);
 
     // Needed because VTK can pick the wrong format with certain drivers
     this->MainPass->SetDepthFormat(vtkTextureObject::Fixed32);
   }
 
-  this->InitializeTime = this->GetMTime();
+  this->FramebuffersBuildTime.Modified();
+  this->InitializedWithBackground = hasBackground;
+  this->InitializedOpaque = opaque;
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DRenderPass::SetInteractive(bool interactive)
+{
+  this->Interactive = interactive;
+  if (this->SSAOPass)
+  {
+    this->SSAOPass->SetInteractive(interactive);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DRenderPass::SetProfiler(vtkF3DGPUProfiler* profiler)
+{
+  if (this->Profiler != profiler)
+  {
+    this->Profiler = profiler;
+    this->Modified();
+  }
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DRenderPass::SetCuller(vtkF3DCuller* culler)
+{
+  if (this->Culler != culler)
+  {
+    this->Culler = culler;
+    this->Modified();
+  }
+}
+
+// ----------------------------------------------------------------------------
+vtkF3DSSAOPass* vtkF3DRenderPass::GetSSAOPass()
+{
+  return this->SSAOPass;
+}
+
+// ----------------------------------------------------------------------------
+vtkF3DDepthPrepass* vtkF3DRenderPass::GetDepthPrepass()
+{
+  return this->DepthPrepass;
 }
 
 // ----------------------------------------------------------------------------
 void vtkF3DRenderPass::Render(const vtkRenderState* s)
 {
+  // the props are sorted at each frame so that adding or removing an actor does not require
+  // to rebuild the render targets, unless the need of a background texture or the opacity changes
+  this->SortProps(s);
   this->Initialize(s);
 
-  vtkRenderState backgroundState(s->GetRenderer());
-  backgroundState.SetPropArrayAndCount(this->BackgroundProps.data(), static_cast<int>(this->BackgroundProps.size()));
-  backgroundState.SetFrameBuffer(s->GetFrameBuffer());
+  if (!this->MainPass)
+  {
+    // no background texture to blend with and no post processing
+    vtkRenderState mainState(s->GetRenderer());
+    mainState.SetPropArrayAndCount(
+      this->MainProps.data(), static_cast<int>(this->MainProps.size()));
+    mainState.SetFrameBuffer(s->GetFrameBuffer());
+
+    this->MainDelegatePass->Render(&mainState);
+
+    this->NumberOfRenderedProps = this->MainDelegatePass->GetNumberOfRenderedProps();
+    return;
+  }
+
+  if (this->BackgroundPass)
+  {
+    vtkRenderState backgroundState(s->GetRenderer());
+    backgroundState.SetPropArrayAndCount(
+      this->BackgroundProps.data(), static_cast<int>(this->BackgroundProps.size()));
+    backgroundState.SetFrameBuffer(s->GetFrameBuffer());
 
-  this->BackgroundPass->Render(&backgroundState);
+    this->BackgroundPass->Render(&backgroundState);
+
+    if (this->Profiler)
+    {
+      this->Profiler->Mark("Background");
+    }
+  }
 
   vtkRenderState mainState(s->GetRenderer());
   mainState.SetPropArrayAndCount(this->MainProps.data(), static_cast<int>(this->MainProps.size()));
@@ -196,6 +463,11 @@ void vtkF3DRenderPass::Render(const vtkRenderState* s)
 
   this->Blend(s);
 
+  if (this->Profiler)
+  {
+    this->Profiler->Mark(this->UseToneMapping || this->UseFXAA ? "Post processing" : "Blend");
+  }
+
   this->NumberOfRenderedProps = this->MainPass->GetNumberOfRenderedProps();
 }
 
@@ -212,8 +484,13 @@ void vtkF3DRenderPass::Blend(const vtkRenderState* s)
   ostate->vtkglDisable(GL_DEPTH_TEST);
   ostate->vtkglDisable(GL_BLEND);
 
-  if (this->BlendQuadHelper && this->BlendQuadHelper->ShaderChangeValue < this->GetMTime())
+  // the shader only depends on the post processing and the presence of a background
+  bool hasBackground = this->BackgroundPass != nullptr;
+  if (this->BlendQuadHelper &&
+    (this->BlendQuadHelper->ShaderChangeValue < this->BlendConfigTime.GetMTime() ||
+      this->BlendWithBackground != hasBackground))
   {
+    this->BlendQuadHelper->ReleaseGraphicsResources(renWin);
     this->BlendQuadHelper = nullptr;
   }
 
@@ -221,48 +498,157 @@ void vtkF3DRenderPass::Blend(const vtkRenderState* s)
   {
     std::string FSSource = vtkOpenGLRenderUtilities::GetFullScreenQuadFragmentShaderTemplate();
 
+    // The composited color of a pixel is computed by a function so that the fused FXAA can
+    // evaluate it at the location of each of its samples
     std::stringstream ssDecl;
     ssDecl << "uniform sampler2D texBackground;\n"
-              "uniform sampler2D texMain;\n"
-              "#define SAMPLES 200\n"
-              "#define GOLDEN_ANGLE 2.399963\n"
-              "vec3 BokehBlur(vec2 tcoords, float radius)"
+              "uniform sampler2D texMain;\n";
+
+    bool blurBackground = hasBackground && this->UseBlurBackground;
+    if (blurBackground)
+    {
+      ssDecl << "#define SAMPLES 200\n"
+                "#define GOLDEN_ANGLE 2.399963\n"
+                "vec3 BokehBlur(vec2 tcoords, float radius)\n"
+                "{\n"
+                "  vec3 acc = vec3(0.0);\n"
+                "  float factor = radius / sqrt(float(SAMPLES));\n"
+                "  for (int i = 0; i < SAMPLES; i++)\n"
+                "  {\n"
+                "    float theta = float(i) * GOLDEN_ANGLE;\n"
+                "    float r = factor * sqrt(float(i));\n"
+                "    vec2 pt = vec2(r * cos(theta), r * sin(theta));\n"
+                "    vec3 col = texture(texBackground, tcoords + pt).rgb;\n"
+                "    acc += col;\n"
+                "  }\n"
+                "  return acc / vec3(SAMPLES);\n"
+                "}\n";
+    }
+
+    if (this->UseToneMapping)
+    {
+      // Same curve and presets as vtkToneMappingPass::SetGenericFilmicDefaultPresets
+      const double contrast = 1.6773;
+      const double shoulder = 0.9714;
+      const double midIn = 0.18;
+      const double midOut = 0.18;
+      const double hdrMax = 11.0785;
+
+      double ad = contrast * shoulder;
+      double denom = (std::pow(hdrMax, ad) - std::pow(midIn, ad)) * midOut;
+      double b = (-std::pow(midIn, contrast) + std::pow(hdrMax, contrast) * midOut) / denom;
+      double c = (std::pow(hdrMax, ad) * std::pow(midIn, contrast) -
+                   std::pow(hdrMax, contrast) * std::pow(midIn, ad) * midOut) /
+        denom;
+
+      ssDecl << "vec3 ToneMap(vec3 color)\n"
+                "{\n"
+                "  color = vec3(dot(vec3(0.59719, 0.35458, 0.04823), color),\n"
+                "    dot(vec3(0.07600, 0.90834, 0.01566), color),\n"
+                "    dot(vec3(0.02840, 0.13383, 0.83777), color));\n"
+                "  vec3 z = pow(max(color, vec3(0.0)), vec3("
+             << contrast << "));\n"
+             << "  color = z / (pow(z, vec3(" << shoulder << ")) * " << b << " + " << c
+             << ");\n"
+                "  color = vec3(dot(vec3(1.60475, -0.53108, -0.07367), color),\n"
+                "    dot(vec3(-0.10208, 1.10813, -0.00605), color),\n"
+                "    dot(vec3(-0.00327, -0.07276, 1.07602), color));\n"
+                "  return clamp(color, vec3(0.0), vec3(1.0));\n"
+                "}\n";
+    }
+
+    ssDecl << "vec3 Composite(vec2 tcoords)\n"
               "{\n"
-              "  vec3 acc = vec3(0.0);\n"
-              "  float factor = radius / sqrt(float(SAMPLES));\n"
-              "  for (int i = 0; i < SAMPLES; i++)\n"
-              "  {\n"
-              "    float theta = float(i) * GOLDEN_ANGLE;\n"
-              "    float r = factor * sqrt(float(i));\n"
-              "    vec2 pt = vec2(r * cos(theta), r * sin(theta));\n"
-              "    vec3 col = texture(texBackground, tcoords + pt).rgb;\n"
-              "    acc += col;\n"
-              "  }\n"
-              "  return acc / vec3(SAMPLES);\n"
-              "}\n"
-              "//VTK::FSQ::Decl";
+              "  vec4 mainSample = texture(texMain, tcoords);\n";
+    if (blurBackground)
+    {
+      ssDecl << "  vec3 bgCol = BokehBlur(tcoords, 0.05);\n"
+                "  vec3 result = bgCol * (1.0 - mainSample.a) + mainSample.rgb * mainSample.a;\n";
+    }
+    else if (hasBackground)
+    {
+      ssDecl << "  vec3 bgCol = texture(texBackground, tcoords).rgb;\n"
+                "  vec3 result = bgCol * (1.0 - mainSample.a) + mainSample.rgb * mainSample.a;\n";
+    }
+    else
+    {
+      // the background color has been cleared in the main texture
+      ssDecl << "  vec3 result = mainSample.rgb;\n";
+    }
+    if (this->UseToneMapping)
+    {
+      ssDecl << "  result = ToneMap(result);\n";
+    }
+    ssDecl << "  return result;\n"
+              "}\n";
+
+    if (this->UseFXAA)
+    {
+      // Compact FXAA, a single direction is estimated from the 4 diagonal neighbors and the
+      // pixel is blurred along it, unless it would bring colors outside of the local range
+      ssDecl << "float Luma(vec3 color)\n"
+                "{\n"
+                "  return dot(color, vec3(0.299, 0.587, 0.114));\n"
+                "}\n"
+                "vec3 FXAA(vec2 tcoords)\n"
+                "{\n"
+                "  vec2 px = 1.0 / vec2(textureSize(texMain, 0));\n"
+                "  vec3 rgbM = Composite(tcoords);\n"
+                "  float lumaNW = Luma(Composite(tcoords + vec2(-1.0, -1.0) * px));\n"
+                "  float lumaNE = Luma(Composite(tcoords + vec2(1.0, -1.0) * px));\n"
+                "  float lumaSW = Luma(Composite(tcoords + vec2(-1.0, 1.0) * px));\n"
+                "  float lumaSE = Luma(Composite(tcoords + vec2(1.0, 1.0) * px));\n"
+                "  float lumaM = Luma(rgbM);\n"
+                "  float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));\n"
+                "  float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));\n"
+                "  if (lumaMax - lumaMin < max(0.0312, lumaMax * 0.125))\n"
+                "  {\n"
+                "    return rgbM;\n"
+                "  }\n"
+                "  vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)),\n"
+                "    (lumaNW + lumaSW) - (lumaNE + lumaSE));\n"
+                "  float lumaSum = lumaNW + lumaNE + lumaSW + lumaSE;\n"
+                "  float dirReduce = max(lumaSum * 0.03125, 0.0078125);\n"
+                "  float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);\n"
+                "  dir = clamp(dir * rcpDirMin, vec2(-8.0), vec2(8.0)) * px;\n"
+                "  vec3 rgbA = 0.5 * (Composite(tcoords + dir * (1.0 / 3.0 - 0.5)) +\n"
+                "    Composite(tcoords + dir * (2.0 / 3.0 - 0.5)));\n"
+                "  vec3 rgbB = rgbA * 0.5 + 0.25 * (Composite(tcoords - dir * 0.5) +\n"
+                "    Composite(tcoords + dir * 0.5));\n"
+                "  float lumaB = Luma(rgbB);\n"
+                "  return (lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB;\n"
+                "}\n";
+    }
+
+    ssDecl << "//VTK::FSQ::Decl";
 
     vtkShaderProgram::Substitute(FSSource, "//VTK::FSQ::Decl", ssDecl.str());
 
     std::stringstream ssImpl;
-    ssImpl << "  vec4 mainSample = texture(texMain, texCoord);\n";
-    if (this->UseBlurBackground)
+    if (this->UseFXAA)
     {
-      ssImpl << "  vec3 bgCol = BokehBlur(texCoord, 0.05);\n";
+      ssImpl << "  vec3 result = FXAA(texCoord);\n";
     }
     else
     {
-      ssImpl << "  vec3 bgCol = texture(texBackground, texCoord).rgb;\n";
+      ssImpl << "  vec3 result = Composite(texCoord);\n";
+    }
+    if (hasBackground)
+    {
+      ssImpl << "  gl_FragData[0] = vec4(result, 1.0);\n";
+    }
+    else
+    {
+      ssImpl << "  gl_FragData[0] = vec4(result, texture(texMain, texCoord).a);\n";
     }
-    ssImpl << "  vec3 result = bgCol * (1.0 - mainSample.a) + mainSample.rgb * mainSample.a;\n"
-              "  gl_FragData[0] = vec4(result.rgb, 1.0);\n";
 
     vtkShaderProgram::Substitute(FSSource, "//VTK::FSQ::Impl", ssImpl.str());
 
     this->BlendQuadHelper = std::make_shared<vtkOpenGLQuadHelper>(renWin,
       vtkOpenGLRenderUtilities::GetFullScreenQuadVertexShader().c_str(), FSSource.c_str(), "");
 
-    this->BlendQuadHelper->ShaderChangeValue = this->GetMTime();
+    this->BlendQuadHelper->ShaderChangeValue = this->BlendConfigTime.GetMTime();
+    this->BlendWithBackground = hasBackground;
   }
   else
   {
@@ -275,18 +661,34 @@ void vtkF3DRenderPass::Blend(const vtkRenderState* s)
     return;
   }
 
-  this->BackgroundPass->GetColorTexture()->SetWrapS(vtkTextureObject::ClampToEdge);
-  this->BackgroundPass->GetColorTexture()->SetWrapT(vtkTextureObject::ClampToEdge);
-
-  this->BackgroundPass->GetColorTexture()->Activate();
-  this->MainPass->GetColorTexture()->Activate();
-  this->BlendQuadHelper->Program->SetUniformi(
-    "texBackground", this->BackgroundPass->GetColorTexture()->GetTextureUnit());
-  this->BlendQuadHelper->Program->SetUniformi(
-    "texMain", this->MainPass->GetColorTexture()->GetTextureUnit());
+  // the fused FXAA samples between the pixels
+  int filter = this->UseFXAA ? vtkTextureObject::Linear : vtkTextureObject::Nearest;
+  vtkTextureObject* mainTexture = this->MainPass->GetColorTexture();
+  mainTexture->SetWrapS(vtkTextureObject::ClampToEdge);
+  mainTexture->SetWrapT(vtkTextureObject::ClampToEdge);
+  mainTexture->SetMinificationFilter(filter);
+  mainTexture->SetMagnificationFilter(filter);
+  mainTexture->Activate();
+  this->BlendQuadHelper->Program->SetUniformi("texMain", mainTexture->GetTextureUnit());
+
+  vtkTextureObject* backgroundTexture =
+    this->BackgroundPass ? this->BackgroundPass->GetColorTexture() : nullptr;
+  if (backgroundTexture)
+  {
+    backgroundTexture->SetWrapS(vtkTextureObject::ClampToEdge);
+    backgroundTexture->SetWrapT(vtkTextureObject::ClampToEdge);
+    backgroundTexture->SetMinificationFilter(filter);
+    backgroundTexture->SetMagnificationFilter(filter);
+    backgroundTexture->Activate();
+    this->BlendQuadHelper->Program->SetUniformi(
+      "texBackground", backgroundTexture->GetTextureUnit());
+  }
 
   this->BlendQuadHelper->Render();
 
-  this->BackgroundPass->GetColorTexture()->Deactivate();
-  this->MainPass->GetColorTexture()->Deactivate();
+  mainTexture->Deactivate();
+  if (backgroundTexture)
+  {
+    backgroundTexture->Deactivate();
+  }
 }
@@ -6,7 +6,15 @@
  * It consists of two main passes. The first one renders the background.
  * The second pass renders the dataset with different options (raytracing, SSAO, depth peeling, ...)
  * Once the two passes are rendered into textures, a final shader is applied to combine the
- * background (and optionally blur it using Bokeh depth of field) and the dataset image.
+ * background and the dataset image.
+ * When there is no background prop (skybox) and the scene only contains opaque 3D actors, the
+ * second pass is rendered directly over the cleared background and no texture is used, since
+ * blending it would not change the result. Otherwise the previous textures are kept, so that
+ * the translucent colors are composited the same way.
+ * Optionally, the final shader also applies the tone mapping and the FXAA so that the image
+ * is read and written only once.
+ * The final shader can also blur the background using Bokeh depth of field, unless the renderer
+ * displays a prefiltered HDRI instead.
  *
  * @sa
  * vtkRenderPass
@@ -23,7 +31,12 @@
 #include <memory>
 #include <vector>
 
+class vtkF3DCuller;
+class vtkF3DDepthPrepass;
+class vtkF3DGPUProfiler;
+class vtkF3DSSAOPass;
 class vtkProp;
+class vtkRenderWindow;
 
 class vtkF3DRenderPass : public vtkRenderPass
 {
@@ -34,6 +47,11 @@ public:
 
   void Render(const vtkRenderState* s) override;
 
+  /**
+   * Return the last modification time of the passes, the render targets or the blend shader
+   */
+  vtkMTimeType GetMTime() override;
+
   vtkGetMacro(UseRaytracing, bool);
   vtkSetMacro(UseRaytracing, bool);
   vtkBooleanMacro(UseRaytracing, bool);
@@ -46,37 +64,164 @@ public:
   vtkSetMacro(UseDepthPeelingPass, bool);
   vtkBooleanMacro(UseDepthPeelingPass, bool);
 
+  //@{
+  /**
+   * Set/Get whether the translucent geometry is rendered in a single pass with weighted blended
+   * order independent translucency, whose cost does not depend on the number of layers.
+   * The colors of the layers are approximated. Depth peeling is used instead when both are set.
+   */
+  vtkGetMacro(UseWeightedBlendingPass, bool);
+  vtkSetMacro(UseWeightedBlendingPass, bool);
+  vtkBooleanMacro(UseWeightedBlendingPass, bool);
+  //@}
+
+  //@{
+  /**
+   * Set/Get whether the colors can exceed 1, for example when using a HDRI or tone mapping.
+   * Half float render targets are used in that case, 8 bits targets otherwise.
+   * Changing it only rebuilds the render targets.
+   */
+  vtkGetMacro(UseHighDynamicRange, bool);
+  void SetUseHighDynamicRange(bool use);
+  vtkBooleanMacro(UseHighDynamicRange, bool);
+  //@}
+
+  //@{
+  /**
+   * Set/Get whether the tone mapping and the FXAA are applied by the final shader of this pass,
+   * along with the background blending, instead of separate full screen passes.
+   * Changing them only rebuilds the render targets and the blend shader.
+   */
+  vtkGetMacro(UseToneMapping, bool);
+  void SetUseToneMapping(bool use);
+  vtkBooleanMacro(UseToneMapping, bool);
+  vtkGetMacro(UseFXAA, bool);
+  void SetUseFXAA(bool use);
+  vtkBooleanMacro(UseFXAA, bool);
+  //@}
+
+  //@{
+  /**
+   * Set/Get whether the background is blurred by the final shader of this pass, using a
+   * Bokeh depth of field. Changing it only rebuilds the blend shader.
+   */
   vtkGetMacro(UseBlurBackground, bool);
-  vtkSetMacro(UseBlurBackground, bool);
+  void SetUseBlurBackground(bool use);
   vtkBooleanMacro(UseBlurBackground, bool);
+  //@}
+
+  //@{
+  /**
+   * Set/Get whether the opaque geometry is rendered in a depth only pass before being shaded,
+   * when the measured overdraw is high
+   */
+  vtkGetMacro(UseDepthPrepass, bool);
+  vtkSetMacro(UseDepthPrepass, bool);
+  vtkBooleanMacro(UseDepthPrepass, bool);
+  //@}
 
   vtkGetVector6Macro(Bounds, double);
   vtkSetVector6Macro(Bounds, double);
 
+  //@{
+  /**
+   * Set/Get the SSAO resolution, relative to the viewport size,
+   * and the number of samples of the SSAO kernel.
+   * The full resolution uses vtkSSAOPass, lower ones use vtkF3DSSAOPass.
+   * Defaults are 1 and 200.
+   */
+  vtkGetMacro(SSAOResolution, double);
+  vtkSetMacro(SSAOResolution, double);
+  vtkGetMacro(SSAOKernelSize, int);
+  vtkSetMacro(SSAOKernelSize, int);
+  //@}
+
+  /**
+   * Set whether the user is interacting, lighter passes are used in that case.
+   * This does not modify the pass so it does not need to be initialized again.
+   */
+  void SetInteractive(bool interactive);
+
+  /**
+   * Set the profiler measuring the GPU time of each pass, nullptr to disable the measures
+   */
+  void SetProfiler(vtkF3DGPUProfiler* profiler);
+
+  /**
+   * Set the culler whose occlusion culling is enabled, the visibility of its props is tested
+   * after the opaque pass. nullptr to disable the tests.
+   */
+  void SetCuller(vtkF3DCuller* culler);
+
+  /**
+   * Get the SSAO pass, nullptr if SSAO is not used
+   */
+  vtkF3DSSAOPass* GetSSAOPass();
+
+  /**
+   * Get the depth prepass, nullptr if it is not used
+   */
+  vtkF3DDepthPrepass* GetDepthPrepass();
+
 protected:
   vtkF3DRenderPass() = default;
-  ~vtkF3DRenderPass() override = default;
+  ~vtkF3DRenderPass() override;
 
   void ReleaseGraphicsResources(vtkWindow* w) override;
 
+  void SortProps(const vtkRenderState* s);
+
+  /**
+   * Build the passes rendering the scene only if they have been modified, and the render targets
+   * only if their configuration or the presence of background props changed since the last call
+   */
   void Initialize(const vtkRenderState* s);
 
+  /**
+   * Build the render targets if their configuration, the need of a background texture or the
+   * opacity of the props changed, and make the main pass render the current passes
+   */
+  void InitializeFramebuffers(vtkRenderWindow* renWin, bool hasBackground, bool opaque);
+
   void Blend(const vtkRenderState* s);
 
   bool UseRaytracing = false;
   bool UseSSAOPass = false;
   bool UseDepthPeelingPass = false;
+  bool UseWeightedBlendingPass = false;
+  bool UseDepthPrepass = false;
+  bool UseHighDynamicRange = false;
+  bool UseToneMapping = false;
+  bool UseFXAA = false;
   bool UseBlurBackground = false;
+  bool Interactive = false;
+
+  double SSAOResolution = 1.0;
+  int SSAOKernelSize = 200;
 
   vtkSmartPointer<vtkFramebufferPass> BackgroundPass;
   vtkSmartPointer<vtkFramebufferPass> MainPass;
+  vtkSmartPointer<vtkRenderPass> MainDelegatePass;
+  vtkSmartPointer<vtkF3DSSAOPass> SSAOPass;
+  vtkSmartPointer<vtkF3DDepthPrepass> DepthPrepass;
+  vtkSmartPointer<vtkF3DGPUProfiler> Profiler;
+  vtkSmartPointer<vtkF3DCuller> Culler;
 
   double Bounds[6] = {};
 
-  vtkMTimeType InitializeTime = 0;
+  // the passes rendering the scene depend on the MTime of the object, the render targets and
+  // the blend shader have their own configuration times
+  vtkTimeStamp FramebufferConfigTime;
+  vtkTimeStamp BlendConfigTime;
+  vtkTimeStamp PassesBuildTime;
+  vtkTimeStamp FramebuffersBuildTime;
+  bool InitializedWithBackground = false;
+  bool InitializedOpaque = false;
+  bool BlendWithBackground = false;
 
   std::vector<vtkProp*> BackgroundProps;
   std::vector<vtkProp*> MainProps;
+  bool OpaqueMainProps = true;
 
   std::shared_ptr<vtkOpenGLQuadHelper> BlendQuadHelper;
 
@@ -1,26 +1,38 @@
 #include "vtkF3DRenderer.h"
 
 #include "F3DLog.h"
+#include "vtkF3DDepthPrepass.h"
+#include "vtkF3DHDRICache.h"
 #include "vtkF3DOpenGLGridMapper.h"
+#include "vtkF3DPolyDataMapper.h"
 #include "vtkF3DRenderPass.h"
+#include "vtkF3DSSAOPass.h"
+#include "vtkF3DShaderCache.h"
+#include "vtkF3DTimestampPass.h"
 
+#include <vtkActor.h>
 #include <vtkAxesActor.h>
 #include <vtkBoundingBox.h>
 #include <vtkCamera.h>
 #include <vtkCornerAnnotation.h>
 #include <vtkCullerCollection.h>
-#include <vtkImageData.h>
-#include <vtkImageReader2.h>
-#include <vtkImageReader2Factory.h>
+#include <vtkMapper.h>
 #include <vtkMath.h>
 #include <vtkObjectFactory.h>
 #include <vtkOpenGLFXAAPass.h>
+#include <vtkOpenGLRenderWindow.h>
 #include <vtkOpenGLRenderer.h>
 #include <vtkOpenGLTexture.h>
+#include <vtkPBRIrradianceTexture.h>
+#include <vtkPBRLUTTexture.h>
+#include <vtkPBRPrefilterTexture.h>
+#include <vtkPolyData.h>
+#include <vtkPropCollection.h>
 #include <vtkProperty.h>
 #include <vtkRenderWindow.h>
 #include <vtkTextActor.h>
 #include <vtkTextProperty.h>
+#include <vtkTexture.h>
 #include <vtkToneMappingPass.h>
 #include <vtkVersion.h>
 #include <vtksys/SystemTools.hxx>
@@ -29,13 +41,35 @@
 #include <vtkOSPRayRendererNode.h>
 #endif
 
-#include <vtk_glew.h>
-
+#include <algorithm>
 #include <cctype>
 #include <chrono>
+#include <cmath>
+#include <iomanip>
 
 vtkStandardNewMacro(vtkF3DRenderer);
 
+namespace
+{
+// The image based lighting textures of vtkOpenGLRenderer are reference counted raw pointers
+template <class T>
+void ShareTexture(vtkObjectBase* renderer, T*& rendererTexture, T* texture)
+{
+  if (rendererTexture != texture)
+  {
+    if (rendererTexture)
+    {
+      rendererTexture->UnRegister(renderer);
+    }
+    rendererTexture = texture;
+    if (rendererTexture)
+    {
+      rendererTexture->Register(renderer);
+    }
+  }
+}
+}
+
 //----------------------------------------------------------------------------
 vtkF3DRenderer::vtkF3DRenderer()
 {
@@ -48,11 +82,7 @@ vtkF3DRenderer::~vtkF3DRenderer() = default;
 //----------------------------------------------------------------------------
 void vtkF3DRenderer::ReleaseGraphicsResources(vtkWindow* w)
 {
-  if (this->Timer != 0)
-  {
-    glDeleteQueries(1, &this->Timer);
-    this->Timer = 0;
-  }
+  this->Profiler->ReleaseGraphicsResources();
   this->Superclass::ReleaseGraphicsResources(w);
 }
 
@@ -73,7 +103,7 @@ void vtkF3DRenderer::Initialize(const F3DOptions& options, const std::string& fi
   this->GridVisible = this->Options.Grid;
   this->AxisVisible = this->Options.Axis;
   this->EdgesVisible = this->Options.Edges;
-  this->TimerVisible = this->Options.FPS;
+  this->TimerVisible = this->Options.FPS || this->Options.FrameTimings;
   this->FilenameVisible = this->Options.Filename;
   this->MetaDataVisible = this->Options.MetaData;
   this->UseRaytracing = this->Options.Raytracing;
@@ -85,36 +115,47 @@ void vtkF3DRenderer::Initialize(const F3DOptions& options, const std::string& fi
   this->UseBlurBackground = this->Options.BlurBackground;
   this->UseTrackball = this->Options.Trackball;
 
+  this->Cullers->RemoveAllItems();
+  if (this->Options.Culling || this->Options.OcclusionCulling)
+  {
+    this->Culler->SetMinimumScreenSize(this->Options.CullingSize);
+    this->Culler->SetOcclusionCulling(this->Options.OcclusionCulling);
+    this->AddCuller(this->Culler);
+  }
+
   if (!this->Options.HDRIFile.empty() && !this->GetUseImageBasedLighting())
   {
     std::string fullPath = vtksys::SystemTools::CollapseFullPath(this->Options.HDRIFile);
 
-    auto reader = vtkSmartPointer<vtkImageReader2>::Take(
-      vtkImageReader2Factory::CreateImageReader2(fullPath.c_str()));
-    if (reader)
+    // a renderer without cache uses its own
+    if (!this->HDRICache)
     {
-      reader->SetFileName(fullPath.c_str());
-      reader->Update();
+      this->HDRICache = vtkSmartPointer<vtkF3DHDRICache>::New();
+    }
 
-      vtkNew<vtkTexture> texture;
-      texture->SetColorModeToDirectScalars();
-      texture->MipmapOn();
-      texture->InterpolateOn();
-      texture->SetInputConnection(reader->GetOutputPort());
+    vtkTexture* texture = this->HDRICache->GetTexture(fullPath);
+    if (texture)
+    {
+      // HDRI OpenGL, the textures precomputed from the HDRI are shared with the previous
+      // renderers so that they are not computed again
+      ShareTexture(this, this->EnvMapLookupTable, this->HDRICache->GetLookupTableTexture());
+      ShareTexture(this, this->EnvMapIrradiance, this->HDRICache->GetIrradianceTexture());
+      ShareTexture(this, this->EnvMapPrefiltered, this->HDRICache->GetPrefilterTexture());
 
-      // 8-bit textures are usually gamma-corrected
-      if (reader->GetOutput() && reader->GetOutput()->GetScalarType() == VTK_UNSIGNED_CHAR)
+      this->UseImageBasedLightingOn();
+      if (this->HDRICache->GetEnvironmentTexture())
       {
-        texture->UseSRGBColorSpaceOn();
+        this->SetEnvironmentTexture(this->HDRICache->GetEnvironmentTexture());
       }
+      else
+      {
+        this->SetEnvironmentTexture(texture);
+        this->HDRICache->SetEnvironmentTexture(this->GetEnvironmentTexture());
+      }
+      this->HDRITexture = texture;
 
-      // HDRI OpenGL
-      this->UseImageBasedLightingOn();
-      this->SetEnvironmentTexture(texture);
-
-      // Skybox OpenGL
+      // Skybox OpenGL, the texture is set when setting up the render passes
       this->Skybox->SetProjection(vtkSkybox::Sphere);
-      this->Skybox->SetTexture(texture);
 
 // First version of VTK including the version check (and the feature used)
 #if VTK_VERSION_NUMBER >= VTK_VERSION_CHECK(9, 0, 20200527)
@@ -229,45 +270,88 @@ std::string vtkF3DRenderer::GenerateMetaDataDescription()
 //----------------------------------------------------------------------------
 void vtkF3DRenderer::SetupRenderPasses()
 {
-  // clean up previous pass
-  vtkRenderPass* pass = this->GetPass();
-  if (pass)
+  bool prefilteredBlur = this->UpdateSkyboxTexture();
+
+  // The passes are kept between calls, their setters only modify them when a value actually
+  // changes, so the framebuffers and shaders are only rebuilt when needed
+  if (!this->F3DPass)
   {
-    pass->ReleaseGraphicsResources(this->RenderWindow);
+    this->F3DPass = vtkSmartPointer<vtkF3DRenderPass>::New();
   }
-
-  vtkNew<vtkF3DRenderPass> newPass;
-  newPass->SetUseRaytracing(F3D_MODULE_RAYTRACING && this->UseRaytracing);
-  newPass->SetUseSSAOPass(this->UseSSAOPass);
-  newPass->SetUseDepthPeelingPass(this->UseDepthPeelingPass);
-  newPass->SetUseBlurBackground(this->UseBlurBackground);
+  vtkF3DRenderPass* f3dPass = this->F3DPass;
+  f3dPass->SetUseRaytracing(F3D_MODULE_RAYTRACING && this->UseRaytracing);
+  f3dPass->SetUseSSAOPass(this->UseSSAOPass);
+  f3dPass->SetUseDepthPeelingPass(this->UseDepthPeelingPass);
+  f3dPass->SetUseBlurBackground(this->UseBlurBackground && !prefilteredBlur);
+  f3dPass->SetUseWeightedBlendingPass(this->Options.WeightedBlending);
+  f3dPass->SetUseDepthPrepass(this->Options.DepthPrepass);
+  f3dPass->SetUseHighDynamicRange(this->UseToneMappingPass || this->HDRITexture != nullptr);
+  f3dPass->SetUseToneMapping(this->Options.FusedPostProcessing && this->UseToneMappingPass);
+  f3dPass->SetUseFXAA(this->Options.FusedPostProcessing && this->UseFXAAPass);
+  f3dPass->SetSSAOResolution(this->Options.SSAOResolution);
+  f3dPass->SetSSAOKernelSize(this->Options.SSAOKernelSize);
+  f3dPass->SetInteractive(this->InteractionInProgress);
+  f3dPass->SetProfiler(this->Profiler);
+  f3dPass->SetCuller(this->Options.OcclusionCulling ? this->Culler.Get() : nullptr);
 
   double bounds[6];
   this->ComputeVisiblePropBounds(bounds);
-  newPass->SetBounds(bounds);
+  f3dPass->SetBounds(bounds);
 
   // Image post processing passes
-  vtkSmartPointer<vtkRenderPass> renderingPass = newPass;
+  vtkSmartPointer<vtkRenderPass> renderingPass = f3dPass;
 
-  if (this->UseToneMappingPass)
+  if (this->UseToneMappingPass && !this->Options.FusedPostProcessing)
+  {
+    if (!this->ToneMappingPass)
+    {
+      this->ToneMappingPass = vtkSmartPointer<vtkToneMappingPass>::New();
+      this->ToneMappingPass->SetToneMappingType(vtkToneMappingPass::GenericFilmic);
+      this->ToneMappingPass->SetGenericFilmicDefaultPresets();
+
+      this->ToneMappingTimestampPass = vtkSmartPointer<vtkF3DTimestampPass>::New();
+      this->ToneMappingTimestampPass->SetDelegatePass(this->ToneMappingPass);
+      this->ToneMappingTimestampPass->SetProfiler(this->Profiler);
+      this->ToneMappingTimestampPass->SetSection("Tone mapping");
+    }
+    this->ToneMappingPass->SetDelegatePass(renderingPass);
+    renderingPass = this->ToneMappingTimestampPass;
+  }
+  else if (this->ToneMappingPass)
   {
-    vtkNew<vtkToneMappingPass> toneP;
-    toneP->SetToneMappingType(vtkToneMappingPass::GenericFilmic);
-    toneP->SetGenericFilmicDefaultPresets();
-    toneP->SetDelegatePass(renderingPass);
-    renderingPass = toneP;
+    // detach the delegate first, so its resources are not released
+    this->ToneMappingPass->SetDelegatePass(nullptr);
+    this->ToneMappingPass->ReleaseGraphicsResources(this->RenderWindow);
+    this->ToneMappingPass = nullptr;
+    this->ToneMappingTimestampPass = nullptr;
   }
 
-  if (this->UseFXAAPass)
+  if (this->UseFXAAPass && !this->Options.FusedPostProcessing)
   {
-    vtkNew<vtkOpenGLFXAAPass> fxaaP;
-    fxaaP->SetDelegatePass(renderingPass);
+    if (!this->FXAAPass)
+    {
+      this->FXAAPass = vtkSmartPointer<vtkOpenGLFXAAPass>::New();
 
-    this->SetPass(fxaaP);
-    renderingPass = fxaaP;
+      this->FXAATimestampPass = vtkSmartPointer<vtkF3DTimestampPass>::New();
+      this->FXAATimestampPass->SetDelegatePass(this->FXAAPass);
+      this->FXAATimestampPass->SetProfiler(this->Profiler);
+      this->FXAATimestampPass->SetSection("FXAA");
+    }
+    this->FXAAPass->SetDelegatePass(renderingPass);
+    renderingPass = this->FXAATimestampPass;
+  }
+  else if (this->FXAAPass)
+  {
+    this->FXAAPass->SetDelegatePass(nullptr);
+    this->FXAAPass->ReleaseGraphicsResources(this->RenderWindow);
+    this->FXAAPass = nullptr;
+    this->FXAATimestampPass = nullptr;
   }
 
-  this->SetPass(renderingPass);
+  if (this->GetPass() != renderingPass)
+  {
+    this->SetPass(renderingPass);
+  }
 
 #if F3D_MODULE_RAYTRACING
   vtkOSPRayRendererNode::SetRendererType("pathtracer", this);
@@ -292,6 +376,24 @@ void vtkF3DRenderer::SetupRenderPasses()
 #endif
 }
 
+//----------------------------------------------------------------------------
+void vtkF3DRenderer::ResetRenderPasses()
+{
+  vtkRenderPass* pass = this->GetPass();
+  if (pass)
+  {
+    pass->ReleaseGraphicsResources(this->RenderWindow);
+  }
+  this->SetPass(nullptr);
+  this->F3DPass = nullptr;
+  this->ToneMappingPass = nullptr;
+  this->ToneMappingTimestampPass = nullptr;
+  this->FXAAPass = nullptr;
+  this->FXAATimestampPass = nullptr;
+
+  this->SetupRenderPasses();
+}
+
 //----------------------------------------------------------------------------
 void vtkF3DRenderer::ShowOptions()
 {
@@ -302,10 +404,27 @@ void vtkF3DRenderer::ShowOptions()
   this->ShowFilename(this->FilenameVisible);
   this->ShowCheatSheet(this->CheatSheetVisible);
   this->ShowMetaData(this->MetaDataVisible);
+  this->UpdateMappers();
 
   this->UpdateInternalActors();
 }
 
+//----------------------------------------------------------------------------
+void vtkF3DRenderer::UpdateMappers()
+{
+  vtkActor* anActor;
+  vtkActorCollection* ac = this->GetActors();
+  vtkCollectionSimpleIterator ait;
+  for (ac->InitTraversal(ait); (anActor = ac->GetNextActor(ait));)
+  {
+    vtkF3DPolyDataMapper* mapper = vtkF3DPolyDataMapper::SafeDownCast(anActor->GetMapper());
+    if (mapper)
+    {
+      mapper->SetCompactVertexBuffers(this->Options.CompactVertexBuffers);
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkF3DRenderer::ShowAxis(bool show)
 {
@@ -326,7 +445,6 @@ void vtkF3DRenderer::ShowAxis(bool show)
   }
 
   this->AxisVisible = show;
-  this->SetupRenderPasses();
   this->CheatSheetNeedUpdate = true;
 }
 
@@ -405,6 +523,45 @@ void vtkF3DRenderer::SetUseDepthPeelingPass(bool use)
   this->CheatSheetNeedUpdate = true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkF3DRenderer::UpdateSkyboxTexture()
+{
+  if (!this->HDRITexture)
+  {
+    return false;
+  }
+
+  vtkTexture* blurredTexture = this->UseBlurBackground && this->Options.PrefilteredBlur
+    ? this->HDRICache->GetBlurredTexture()
+    : nullptr;
+  this->Skybox->SetTexture(blurredTexture ? blurredTexture : this->HDRITexture.Get());
+  return blurredTexture != nullptr;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DRenderer::SetHDRICache(vtkF3DHDRICache* cache)
+{
+  this->HDRICache = cache;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DRenderer::DetachHDRI()
+{
+  if (!this->HDRITexture)
+  {
+    return;
+  }
+
+  this->Skybox->SetTexture(nullptr);
+  this->SetEnvironmentTexture(nullptr);
+  this->UseImageBasedLightingOff();
+  this->HDRITexture = nullptr;
+
+  ShareTexture<vtkPBRLUTTexture>(this, this->EnvMapLookupTable, nullptr);
+  ShareTexture<vtkPBRIrradianceTexture>(this, this->EnvMapIrradiance, nullptr);
+  ShareTexture<vtkPBRPrefilterTexture>(this, this->EnvMapPrefiltered, nullptr);
+}
+
 //----------------------------------------------------------------------------
 bool vtkF3DRenderer::UsingBlurBackground()
 {
@@ -506,7 +663,6 @@ void vtkF3DRenderer::ShowTimer(bool show)
     this->TimerActor->SetVisibility(show);
   }
   this->TimerVisible = show;
-  this->SetupRenderPasses();
   this->CheatSheetNeedUpdate = true;
 }
 
@@ -526,7 +682,6 @@ void vtkF3DRenderer::ShowFilename(bool show)
     this->FilenameActor->SetVisibility(show);
   }
   this->FilenameVisible = show;
-  this->SetupRenderPasses();
   this->CheatSheetNeedUpdate = true;
 }
 
@@ -551,7 +706,6 @@ void vtkF3DRenderer::ShowMetaData(bool show)
     this->MetaDataActor->SetVisibility(show);
   }
   this->MetaDataVisible = show;
-  this->SetupRenderPasses();
   this->CheatSheetNeedUpdate = true;
 }
 
@@ -575,7 +729,6 @@ void vtkF3DRenderer::ShowCheatSheet(bool show)
     }
   }
   this->CheatSheetVisible = show;
-  this->SetupRenderPasses();
   this->CheatSheetNeedUpdate = true;
 }
 
@@ -640,7 +793,14 @@ void vtkF3DRenderer::ShowEdge(bool show)
   {
     if (vtkSkybox::SafeDownCast(anActor) == nullptr)
     {
-      anActor->GetProperty()->SetEdgeVisibility(show);
+      // the F3D mapper can draw the edges in the same pass as the surface
+      vtkF3DPolyDataMapper* mapper = vtkF3DPolyDataMapper::SafeDownCast(anActor->GetMapper());
+      bool singlePass = mapper && this->Options.SinglePassEdges;
+      anActor->GetProperty()->SetEdgeVisibility(show && !singlePass);
+      if (mapper)
+      {
+        mapper->SetEdgeVisibility(show && singlePass);
+      }
     }
   }
   this->EdgesVisible = show;
@@ -666,6 +826,23 @@ bool vtkF3DRenderer::UsingTrackball()
   return this->UseTrackball;
 }
 
+//----------------------------------------------------------------------------
+void vtkF3DRenderer::SetInteractionInProgress(bool interacting)
+{
+  this->InteractionInProgress = interacting;
+  this->Culler->SetInteractive(interacting);
+  if (this->F3DPass)
+  {
+    this->F3DPass->SetInteractive(interacting);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DRenderer::IsInteractionInProgress()
+{
+  return this->InteractionInProgress;
+}
+
 //----------------------------------------------------------------------------
 void vtkF3DRenderer::Render()
 {
@@ -682,33 +859,66 @@ void vtkF3DRenderer::Render()
   }
 
   auto cpuStart = std::chrono::high_resolution_clock::now();
-  if (this->Timer == 0)
-  {
-    glGenQueries(1, &this->Timer);
-  }
 
-  glBeginQuery(GL_TIME_ELAPSED, this->Timer);
+  // the GPU times are the ones of a previous frame, so that the CPU does not wait for the GPU
+  this->Profiler->BeginFrame();
 
   this->TimerActor->RenderOpaqueGeometry(this); // update texture
 
   this->Superclass::Render();
 
-  auto cpuElapsed = std::chrono::high_resolution_clock::now() - cpuStart;
+  this->Profiler->EndFrame();
 
-  // Get CPU frame per seconds
-  int fps = static_cast<int>(std::round(
-    1.0 / (std::chrono::duration_cast<std::chrono::microseconds>(cpuElapsed).count() * 1e-6)));
+  std::chrono::duration<double, std::milli> cpuElapsed =
+    std::chrono::high_resolution_clock::now() - cpuStart;
+  double cpuTime = cpuElapsed.count();
+  double gpuTime = this->Profiler->GetFrameTime();
 
-  glEndQuery(GL_TIME_ELAPSED);
-  GLint elapsed;
-  glGetQueryObjectiv(this->Timer, GL_QUERY_RESULT, &elapsed);
+  // the frame rate is limited by the slowest of the CPU and the GPU
+  int fps = static_cast<int>(std::round(1000.0 / std::max(cpuTime, gpuTime)));
 
-  // Get min between CPU frame per seconds and GPU frame per seconds
-  fps = std::min(fps, static_cast<int>(std::round(1.0 / (elapsed * 1e-9))));
+  std::stringstream str;
+  if (this->Options.FrameTimings)
+  {
+    str << std::fixed << std::setprecision(2);
+    for (const auto& section : this->Profiler->GetSectionTimes())
+    {
+      str << section.first << ": " << section.second << " ms\n";
+    }
+    str << "GPU: " << gpuTime << " ms, CPU: " << cpuTime << " ms\n";
+    str << this->GetNumberOfPropsRendered() << " props, " << this->GetNumberOfPolygons()
+        << " polygons\n";
+    if (this->Options.Culling || this->Options.OcclusionCulling)
+    {
+      str << this->Culler->GetNumberOfDrawnProps() << " parts drawn, "
+          << this->Culler->GetNumberOfCulledProps() << " culled, "
+          << this->Culler->GetNumberOfOccludedProps() << " occluded\n";
+    }
+  }
+  str << fps << " fps";
+  this->TimerActor->SetInput(str.str().c_str());
+}
 
-  std::string str = std::to_string(fps);
-  str += " fps";
-  this->TimerActor->SetInput(str.c_str());
+//----------------------------------------------------------------------------
+vtkIdType vtkF3DRenderer::GetNumberOfPolygons()
+{
+  vtkIdType nbPolygons = 0;
+  vtkPropCollection* props = this->GetViewProps();
+  vtkCollectionSimpleIterator it;
+  props->InitTraversal(it);
+  while (vtkProp* prop = props->GetNextProp(it))
+  {
+    vtkActor* actor = vtkActor::SafeDownCast(prop);
+    if (actor && actor->GetVisibility() && actor->GetMapper() && !vtkSkybox::SafeDownCast(actor))
+    {
+      vtkPolyData* polyData = vtkPolyData::SafeDownCast(actor->GetMapper()->GetInput());
+      if (polyData)
+      {
+        nbPolygons += polyData->GetNumberOfPolys() + polyData->GetNumberOfStrips();
+      }
+    }
+  }
+  return nbPolygons;
 }
 
 //----------------------------------------------------------------------------
@@ -748,4 +958,51 @@ void vtkF3DRenderer::DumpSceneState()
   F3DLog::Print(
     F3DLog::Severity::Info, "Camera focal point: ", focal[0], ",", focal[1], ",", focal[2]);
   F3DLog::Print(F3DLog::Severity::Info, "Camera view up: ", up[0], ",", up[1], ",", up[2], "\n");
+
+  vtkF3DSSAOPass* ssaoPass = this->F3DPass ? this->F3DPass->GetSSAOPass() : nullptr;
+  if (ssaoPass)
+  {
+    F3DLog::Print(F3DLog::Severity::Info, "SSAO at ", ssaoPass->GetResolutionScale(),
+      " resolution: ", ssaoPass->GetAverageTime(false), " ms with ", ssaoPass->GetKernelSize(),
+      " samples, ", ssaoPass->GetAverageTime(true), " ms with ",
+      ssaoPass->GetInteractiveKernelSize(), " samples while interacting\n");
+  }
+
+  vtkF3DDepthPrepass* depthPrepass = this->F3DPass ? this->F3DPass->GetDepthPrepass() : nullptr;
+  if (depthPrepass)
+  {
+    F3DLog::Print(F3DLog::Severity::Info, "Depth prepass ",
+      depthPrepass->GetPrepassUsed() ? "used" : "not used", ", overdraw of ",
+      depthPrepass->GetOverdraw(), " for a threshold of ", depthPrepass->GetOverdrawThreshold(),
+      "\n");
+  }
+
+  if (this->Options.Culling || this->Options.OcclusionCulling)
+  {
+    F3DLog::Print(F3DLog::Severity::Info, "Culling: ", this->Culler->GetNumberOfDrawnProps(),
+      " parts drawn, ", this->Culler->GetNumberOfCulledProps(), " culled, ",
+      this->Culler->GetNumberOfOccludedProps(), " occluded\n");
+  }
+
+  if (this->TimerVisible)
+  {
+    std::stringstream timings;
+    timings << "GPU frame time: " << this->Profiler->GetFrameTime() << " ms\n";
+    for (const auto& section : this->Profiler->GetSectionTimes())
+    {
+      timings << "  " << section.first << ": " << section.second << " ms\n";
+    }
+    F3DLog::Print(F3DLog::Severity::Info, timings.str());
+  }
+
+  vtkOpenGLRenderWindow* glRenWin = vtkOpenGLRenderWindow::SafeDownCast(this->RenderWindow);
+  vtkF3DShaderCache* shaderCache =
+    glRenWin ? vtkF3DShaderCache::SafeDownCast(glRenWin->GetShaderCache()) : nullptr;
+  if (shaderCache)
+  {
+    F3DLog::Print(F3DLog::Severity::Info, "Shader cache: ", shaderCache->GetNumberOfHits(),
+      " programs loaded, ", shaderCache->GetNumberOfMisses(), " programs compiled in ",
+      shaderCache->GetCompileTime(), " ms, ", shaderCache->GetSavedTime(),
+      " ms of compilation saved\n");
+  }
 }
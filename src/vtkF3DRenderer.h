@@ -12,13 +12,21 @@
 #define vtkF3DRenderer_h
 
 #include "F3DOptions.h"
+#include "vtkF3DCuller.h"
+#include "vtkF3DGPUProfiler.h"
 
 #include <vtkOpenGLRenderer.h>
 #include <vtkOrientationMarkerWidget.h>
 #include <vtkSkybox.h>
 
 class vtkCornerAnnotation;
+class vtkF3DHDRICache;
+class vtkF3DRenderPass;
+class vtkF3DTimestampPass;
+class vtkOpenGLFXAAPass;
 class vtkTextActor;
+class vtkTexture;
+class vtkToneMappingPass;
 
 class vtkF3DRenderer : public vtkOpenGLRenderer
 {
@@ -68,6 +76,16 @@ public:
   bool UsingTrackball();
   //@}
 
+  //@{
+  /**
+   * Set/Get whether the user is currently interacting with the scene,
+   * eg. rotating the camera with the mouse.
+   * Override to render a lighter scene during interactions.
+   */
+  virtual void SetInteractionInProgress(bool interacting);
+  bool IsInteractionInProgress();
+  //@}
+
   /**
    * Reimplemented to handle cheat sheet and timer
    */
@@ -92,6 +110,17 @@ public:
    */
   vtkGetObjectMacro(Skybox, vtkSkybox);
 
+  /**
+   * Set the cache keeping the HDRI textures between renderers, must be set before Initialize
+   */
+  void SetHDRICache(vtkF3DHDRICache* cache);
+
+  /**
+   * Detach the HDRI textures shared with the cache, so that they are not released
+   * when the renderer is removed from its window
+   */
+  void DetachHDRI();
+
   /**
    * Set the visibility of the different actors
    * as they were set by the options during the initialization.
@@ -102,9 +131,15 @@ public:
   /**
    * Setup the different render passes
    * as they were set by the options during the initialization.
+   * The passes are kept between calls and only the ones affected by a change are rebuilt.
    */
   void SetupRenderPasses();
 
+  /**
+   * Release and recreate all the render passes, needed when the OpenGL context changes.
+   */
+  void ResetRenderPasses();
+
   /**
    * Initialize the camera position, focal point,
    * view up and view angle according to the options if any
@@ -117,7 +152,8 @@ public:
   void ResetCamera() override;
 
   /**
-   * Dump useful scene state. Currently supports only camera state.
+   * Dump useful scene state: the camera, the shader cache statistics and,
+   * if the timer is visible, the GPU time of each render pass.
    */
   void DumpSceneState();
 
@@ -167,11 +203,37 @@ protected:
    */
   virtual std::string GenerateMetaDataDescription();
 
+  /**
+   * Display the HDRI or its blurred version in the skybox, depending on the blur background
+   * and prefiltered blur options. The blurred HDRI is computed by the cache, when it is first
+   * needed. Returns true if the skybox displays the blurred HDRI, in which case the background
+   * must not be blurred again by the render pass.
+   */
+  bool UpdateSkyboxTexture();
+
+  /**
+   * Set the options of the F3D mappers of the actors, such as the compact vertex buffers
+   */
+  void UpdateMappers();
+
+  /**
+   * Count the polygons and triangle strips of the visible actors, displayed with the frame timings
+   */
+  vtkIdType GetNumberOfPolygons();
+
   F3DOptions Options;
 
+  vtkSmartPointer<vtkF3DRenderPass> F3DPass;
+  vtkSmartPointer<vtkToneMappingPass> ToneMappingPass;
+  vtkSmartPointer<vtkF3DTimestampPass> ToneMappingTimestampPass;
+  vtkSmartPointer<vtkOpenGLFXAAPass> FXAAPass;
+  vtkSmartPointer<vtkF3DTimestampPass> FXAATimestampPass;
+
   vtkNew<vtkActor> GridActor;
 
   vtkNew<vtkSkybox> Skybox;
+  vtkSmartPointer<vtkTexture> HDRITexture;
+  vtkSmartPointer<vtkF3DHDRICache> HDRICache;
   vtkNew<vtkCamera> InitialCamera;
 
   vtkSmartPointer<vtkOrientationMarkerWidget> AxisWidget;
@@ -183,7 +245,10 @@ protected:
 
   // vtkCornerAnnotation building is too slow for the timer
   vtkNew<vtkTextActor> TimerActor;
-  unsigned int Timer = 0;
+  vtkNew<vtkF3DGPUProfiler> Profiler;
+
+  // the default VTK culler is replaced by this one when enabled by the options
+  vtkNew<vtkF3DCuller> Culler;
 
   bool GridVisible = false;
   bool AxisVisible = false;
@@ -200,6 +265,7 @@ protected:
   bool UseToneMappingPass = false;
   bool UseBlurBackground = false;
   bool UseTrackball = false;
+  bool InteractionInProgress = false;
 
   double UpVector[3] = { 0.0, 1.0, 0.0 };
   double RightVector[3] = { 1.0, 0.0, 0.0 };
@@ -1,6 +1,8 @@
 #include "vtkF3DRendererWithColoring.h"
 
 #include "F3DLog.h"
+#include "vtkF3DPointCloudLODMapper.h"
+#include "vtkF3DVolumeLODMapper.h"
 
 #include <vtkColorTransferFunction.h>
 #include <vtkDataSetAttributes.h>
@@ -10,6 +12,8 @@
 #include <vtkPolyData.h>
 #include <vtkVolumeProperty.h>
 
+#include <chrono>
+
 vtkStandardNewMacro(vtkF3DRendererWithColoring);
 
 //----------------------------------------------------------------------------
@@ -20,6 +24,8 @@ void vtkF3DRendererWithColoring::Initialize(const F3DOptions& options, const std
   this->SetScalarBarActor(nullptr);
   this->SetGeometryActor(nullptr);
   this->SetPointSpritesActor(nullptr);
+  this->SetProxyActor(nullptr);
+  this->ProxyGeometry = std::shared_future<vtkSmartPointer<vtkPolyData> >();
   this->SetVolumeProp(nullptr);
   this->SetPolyDataMapper(nullptr);
   this->SetPointGaussianMapper(nullptr);
@@ -94,6 +100,84 @@ std::string vtkF3DRendererWithColoring::GenerateMetaDataDescription()
   return description;
 }
 
+//----------------------------------------------------------------------------
+void vtkF3DRendererWithColoring::SetProxyGeometry(
+  const std::shared_future<vtkSmartPointer<vtkPolyData> >& geometry)
+{
+  this->ProxyGeometry = geometry;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DRendererWithColoring::SetInteractionInProgress(bool interacting)
+{
+  this->Superclass::SetInteractionInProgress(interacting);
+
+  vtkF3DPointCloudLODMapper* lodMapper =
+    vtkF3DPointCloudLODMapper::SafeDownCast(this->PointGaussianMapper);
+  if (lodMapper)
+  {
+    lodMapper->SetInteractive(interacting);
+  }
+
+  vtkF3DVolumeLODMapper* volumeLODMapper = vtkF3DVolumeLODMapper::SafeDownCast(this->VolumeMapper);
+  if (volumeLODMapper)
+  {
+    volumeLODMapper->SetInteractive(interacting);
+  }
+
+  if (!this->ProxyActor || !this->GeometryActor)
+  {
+    return;
+  }
+
+  if (interacting)
+  {
+    if (this->GeometryActor->GetVisibility() && this->UpdateProxy())
+    {
+      this->GeometryActor->VisibilityOff();
+      this->ProxyActor->VisibilityOn();
+    }
+  }
+  else if (this->ProxyActor->GetVisibility())
+  {
+    this->ProxyActor->VisibilityOff();
+    this->GeometryActor->VisibilityOn();
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DRendererWithColoring::UpdateProxy()
+{
+  if (!this->ProxyGeometry.valid() ||
+    this->ProxyGeometry.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+  {
+    return false;
+  }
+
+  vtkPolyData* proxy = this->ProxyGeometry.get();
+  vtkPolyDataMapper* proxyMapper = vtkPolyDataMapper::SafeDownCast(this->ProxyActor->GetMapper());
+  if (!proxy || !proxyMapper || !this->PolyDataMapper)
+  {
+    return false;
+  }
+
+  if (proxyMapper->GetInput() != proxy)
+  {
+    proxyMapper->SetInputData(proxy);
+  }
+
+  // only modify the proxy mapper when the coloring actually changed
+  proxyMapper->SetLookupTable(this->PolyDataMapper->GetLookupTable());
+  proxyMapper->SetScalarVisibility(this->PolyDataMapper->GetScalarVisibility());
+  proxyMapper->SetScalarMode(this->PolyDataMapper->GetScalarMode());
+  proxyMapper->SetColorMode(this->PolyDataMapper->GetColorMode());
+  proxyMapper->SetScalarRange(this->PolyDataMapper->GetScalarRange());
+  proxyMapper->SetInterpolateScalarsBeforeMapping(
+    this->PolyDataMapper->GetInterpolateScalarsBeforeMapping());
+  proxyMapper->SelectColorArray(this->PolyDataMapper->GetArrayName());
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void vtkF3DRendererWithColoring::SetUsePointSprites(bool use)
 {
@@ -298,7 +382,6 @@ void vtkF3DRendererWithColoring::ShowScalarBar(bool show)
 {
   this->ScalarBarVisible = show;
   this->UpdateScalarBarVisibility();
-  this->SetupRenderPasses();
   this->CheatSheetNeedUpdate = true;
 }
 
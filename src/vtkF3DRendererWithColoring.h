@@ -12,10 +12,13 @@
 
 #include "vtkF3DRenderer.h"
 
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkScalarBarActor.h>
 #include <vtkSmartVolumeMapper.h>
 
+#include <future>
+
 class vtkColorTransferFunction;
 class vtkDataSetAttributes;
 
@@ -93,6 +96,25 @@ public:
   vtkSetSmartPointerMacro(GeometryActor, vtkActor);
   //@}
 
+  //@{
+  /**
+   * Set/Get the proxy actor, rendered instead of the geometry actor while interacting
+   */
+  vtkGetSmartPointerMacro(ProxyActor, vtkActor);
+  vtkSetSmartPointerMacro(ProxyActor, vtkActor);
+  //@}
+
+  /**
+   * Set the geometry of the proxy actor, which may still be computed in the background.
+   * The proxy actor is only used once the geometry is available.
+   */
+  void SetProxyGeometry(const std::shared_future<vtkSmartPointer<vtkPolyData> >& geometry);
+
+  /**
+   * Reimplemented to render the proxy actor while interacting
+   */
+  void SetInteractionInProgress(bool interacting) override;
+
   //@{
   /**
    * Set/Get the point sprites actor
@@ -162,6 +184,13 @@ protected:
 
   void UpdateScalarBarVisibility();
 
+  /**
+   * Set the proxy geometry on the proxy mapper if it is available
+   * and configure it to be colored like the polydata mapper.
+   * Return true if the proxy actor can be rendered.
+   */
+  bool UpdateProxy();
+
   void FillCheatSheetHotkeys(std::stringstream& sheet) override;
 
   /**
@@ -218,6 +247,9 @@ protected:
   vtkSmartPointer<vtkActor> PointSpritesActor;
   vtkSmartPointer<vtkVolume> VolumeProp;
 
+  vtkSmartPointer<vtkActor> ProxyActor;
+  std::shared_future<vtkSmartPointer<vtkPolyData> > ProxyGeometry;
+
   vtkSmartPointer<vtkScalarBarActor> ScalarBarActor;
   bool ScalarBarActorConfigured = false;
 
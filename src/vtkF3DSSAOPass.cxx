@@ -0,0 +1,561 @@
+#include "vtkF3DSSAOPass.h"
+
+#include <vtkMatrix3x3.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkOpenGLCamera.h>
+#include <vtkOpenGLFramebufferObject.h>
+#include <vtkOpenGLPolyDataMapper.h>
+#include <vtkOpenGLQuadHelper.h>
+#include <vtkOpenGLRenderUtilities.h>
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkOpenGLShaderCache.h>
+#include <vtkOpenGLState.h>
+#include <vtkRenderState.h>
+#include <vtkRenderer.h>
+#include <vtkShaderProgram.h>
+#include <vtkTextureObject.h>
+#include <vtk_glew.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+vtkStandardNewMacro(vtkF3DSSAOPass);
+
+// ----------------------------------------------------------------------------
+vtkF3DSSAOPass::~vtkF3DSSAOPass() = default;
+
+// ----------------------------------------------------------------------------
+void vtkF3DSSAOPass::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Radius: " << this->Radius << "\n";
+  os << indent << "Bias: " << this->Bias << "\n";
+  os << indent << "KernelSize: " << this->KernelSize << "\n";
+  os << indent << "InteractiveKernelSize: " << this->InteractiveKernelSize << "\n";
+  os << indent << "ResolutionScale: " << this->ResolutionScale << "\n";
+}
+
+// ----------------------------------------------------------------------------
+double vtkF3DSSAOPass::GetAverageTime(bool interactive)
+{
+  const Timing& timing = this->Timings[interactive ? 1 : 0];
+  return timing.Count > 0 ? timing.TotalTime / timing.Count : 0.0;
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DSSAOPass::ComputeKernel()
+{
+  if (this->Kernel.size() == 3 * static_cast<size_t>(this->KernelSize))
+  {
+    return;
+  }
+
+  // The samples are randomly distributed in the hemisphere, including their distance to the
+  // center, so that any subset of the first samples can be used as a smaller kernel.
+  // A fixed seed is used to get reproducible images.
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> random(0.f, 1.f);
+
+  this->Kernel.resize(3 * this->KernelSize);
+  for (int i = 0; i < this->KernelSize; i++)
+  {
+    float sample[3] = { 2.f * random(generator) - 1.f, 2.f * random(generator) - 1.f,
+      random(generator) };
+    float norm = std::sqrt(sample[0] * sample[0] + sample[1] * sample[1] + sample[2] * sample[2]);
+
+    // more samples close to the center
+    float distance = random(generator);
+    float scale = (0.1f + 0.9f * distance * distance) / std::max(norm, 1e-6f);
+
+    this->Kernel[3 * i] = sample[0] * scale;
+    this->Kernel[3 * i + 1] = sample[1] * scale;
+    this->Kernel[3 * i + 2] = sample[2] * scale;
+  }
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DSSAOPass::InitializeGraphicsResources(
+  vtkOpenGLRenderWindow* renWin, int w, int h, int sw, int sh)
+{
+  auto initializeTexture = [&](vtkSmartPointer<vtkTextureObject>& texture, int tw, int th,
+                             int nbComp, bool depth) {
+    if (!texture)
+    {
+      texture = vtkSmartPointer<vtkTextureObject>::New();
+      texture->SetContext(renWin);
+      texture->SetMinificationFilter(vtkTextureObject::Nearest);
+      texture->SetMagnificationFilter(vtkTextureObject::Nearest);
+      texture->SetWrapS(vtkTextureObject::ClampToEdge);
+      texture->SetWrapT(vtkTextureObject::ClampToEdge);
+      if (depth)
+      {
+        texture->AllocateDepth(tw, th, vtkTextureObject::Float32);
+      }
+      else
+      {
+        texture->Allocate2D(tw, th, nbComp, VTK_FLOAT);
+      }
+    }
+    else
+    {
+      texture->Resize(tw, th);
+    }
+  };
+
+  initializeTexture(this->ColorTexture, w, h, 4, false);
+  initializeTexture(this->PositionTexture, w, h, 4, false);
+  initializeTexture(this->NormalTexture, w, h, 4, false);
+  initializeTexture(this->DepthTexture, w, h, 0, true);
+
+  // ambient occlusion and view coordinates depth, used for the upsampling
+  initializeTexture(this->SSAOTexture, sw, sh, 2, false);
+
+  if (!this->FrameBufferObject)
+  {
+    this->FrameBufferObject = vtkSmartPointer<vtkOpenGLFramebufferObject>::New();
+    this->FrameBufferObject->SetContext(renWin);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DSSAOPass::Render(const vtkRenderState* s)
+{
+  vtkOpenGLClearErrorMacro();
+
+  this->NumberOfRenderedProps = 0;
+
+  if (!this->DelegatePass)
+  {
+    vtkWarningMacro("no delegate in vtkF3DSSAOPass.");
+    return;
+  }
+
+  vtkRenderer* r = s->GetRenderer();
+  vtkOpenGLRenderWindow* renWin = static_cast<vtkOpenGLRenderWindow*>(r->GetRenderWindow());
+  vtkOpenGLState* ostate = renWin->GetState();
+
+  vtkOpenGLState::ScopedglEnableDisable bsaver(ostate, GL_BLEND);
+  vtkOpenGLState::ScopedglEnableDisable dsaver(ostate, GL_DEPTH_TEST);
+
+  // the result is combined in the current framebuffer, using its viewport
+  GLint viewport[4];
+  GLint scissor[4];
+  ostate->vtkglGetIntegerv(GL_VIEWPORT, viewport);
+  ostate->vtkglGetIntegerv(GL_SCISSOR_BOX, scissor);
+
+  int x, y, w, h;
+  r->GetTiledSizeAndOrigin(&w, &h, &x, &y);
+  int sw = std::max(1, static_cast<int>(std::lround(w * this->ResolutionScale)));
+  int sh = std::max(1, static_cast<int>(std::lround(h * this->ResolutionScale)));
+
+  if (this->SSAOQuadHelper && this->SSAOQuadHelper->ShaderChangeValue < this->GetMTime())
+  {
+    this->SSAOQuadHelper = nullptr;
+  }
+
+  this->InitializeGraphicsResources(renWin, w, h, sw, sh);
+  this->ComputeKernel();
+
+  this->RenderDelegate(s, w, h);
+
+  this->BeginTiming();
+
+  ostate->PushFramebufferBindings();
+  this->RenderSSAO(renWin, r, sw, sh);
+  ostate->PopFramebufferBindings();
+
+  ostate->vtkglViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+  ostate->vtkglScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+  this->RenderCombine(renWin);
+
+  this->EndTiming();
+
+  vtkOpenGLCheckErrorMacro("failed after Render");
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DSSAOPass::RenderDelegate(const vtkRenderState* s, int w, int h)
+{
+  vtkOpenGLState* ostate = this->FrameBufferObject->GetContext()->GetState();
+
+  this->PreRender(s);
+
+  ostate->PushFramebufferBindings();
+  this->FrameBufferObject->Bind();
+  this->FrameBufferObject->AddColorAttachment(0, this->ColorTexture);
+  this->FrameBufferObject->AddColorAttachment(1, this->PositionTexture);
+  this->FrameBufferObject->AddColorAttachment(2, this->NormalTexture);
+  this->FrameBufferObject->ActivateDrawBuffers(3);
+  this->FrameBufferObject->AddDepthAttachment(this->DepthTexture);
+  this->FrameBufferObject->StartNonOrtho(w, h);
+
+  ostate->vtkglViewport(0, 0, w, h);
+  ostate->vtkglScissor(0, 0, w, h);
+  ostate->vtkglClearColor(0.0, 0.0, 0.0, 0.0);
+  ostate->vtkglClearDepth(1.0);
+  ostate->vtkglClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  this->DelegatePass->Render(s);
+  this->NumberOfRenderedProps += this->DelegatePass->GetNumberOfRenderedProps();
+
+  ostate->PopFramebufferBindings();
+
+  this->PostRender(s);
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DSSAOPass::RenderSSAO(vtkOpenGLRenderWindow* renWin, vtkRenderer* ren, int sw, int sh)
+{
+  if (!this->SSAOQuadHelper)
+  {
+    // each sample uses a uniform vector, a few of them are left to the other uniforms.
+    // GL_MAX_FRAGMENT_UNIFORM_VECTORS is not available before OpenGL 4.1.
+    GLint maxComponents = 0;
+    glGetIntegerv(GL_MAX_FRAGMENT_UNIFORM_COMPONENTS, &maxComponents);
+    this->ShaderKernelSize = std::max(1, std::min(this->KernelSize, maxComponents / 4 - 16));
+    if (this->ShaderKernelSize < this->KernelSize)
+    {
+      vtkWarningMacro(
+        "The SSAO kernel is limited to " << this->ShaderKernelSize << " samples by the GPU");
+    }
+
+    std::string FSSource = vtkOpenGLRenderUtilities::GetFullScreenQuadFragmentShaderTemplate();
+
+    std::stringstream ssDecl;
+    ssDecl << "uniform sampler2D texPosition;\n"
+              "uniform sampler2D texNormal;\n"
+              "uniform vec3 samples["
+           << this->ShaderKernelSize
+           << "];\n"
+              "uniform int kernelSize;\n"
+              "uniform float kernelRadius;\n"
+              "uniform float kernelBias;\n"
+              "uniform mat4 matProjection;\n"
+              "//VTK::FSQ::Decl";
+
+    vtkShaderProgram::Substitute(FSSource, "//VTK::FSQ::Decl", ssDecl.str());
+
+    // the hemisphere is randomly rotated for each pixel using an interleaved gradient noise,
+    // the resulting pattern is removed by the blur of the upsampling
+    std::stringstream ssImpl;
+    ssImpl << "  vec4 position = texture(texPosition, texCoord);\n"
+              "  if (position.w == 0.0)\n"
+              "  {\n"
+              "    gl_FragData[0] = vec4(1.0, 0.0, 0.0, 1.0);\n"
+              "    return;\n"
+              "  }\n"
+              "  vec3 normal = normalize(texture(texNormal, texCoord).xyz);\n"
+              "  float noise = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, "
+              "0.00583715))));\n"
+              "  vec3 randomVec = vec3(cos(6.2831853 * noise), sin(6.2831853 * noise), 0.0);\n"
+              "  vec3 tangent = randomVec - normal * dot(randomVec, normal);\n"
+              "  if (dot(tangent, tangent) < 1e-6)\n"
+              "  {\n"
+              "    tangent = vec3(-randomVec.y, randomVec.x, 0.0);\n"
+              "    tangent -= normal * dot(tangent, normal);\n"
+              "  }\n"
+              "  tangent = normalize(tangent);\n"
+              "  mat3 tbn = mat3(tangent, cross(normal, tangent), normal);\n"
+              "  float occlusion = 0.0;\n"
+              "  for (int i = 0; i < kernelSize; i++)\n"
+              "  {\n"
+              "    vec3 sampleVC = position.xyz + kernelRadius * (tbn * samples[i]);\n"
+              "    vec4 sampleDC = matProjection * vec4(sampleVC, 1.0);\n"
+              "    vec2 sampleTC = clamp(0.5 * sampleDC.xy / sampleDC.w + 0.5, 0.0, 1.0);\n"
+              "    vec4 samplePosition = texture(texPosition, sampleTC);\n"
+              "    if (samplePosition.w > 0.0)\n"
+              "    {\n"
+              "      float rangeCheck = smoothstep(0.0, 1.0, kernelRadius / abs(position.z - "
+              "samplePosition.z));\n"
+              "      occlusion += (samplePosition.z >= sampleVC.z + kernelBias ? 1.0 : 0.0) * "
+              "rangeCheck;\n"
+              "    }\n"
+              "  }\n"
+              "  gl_FragData[0] = vec4(1.0 - occlusion / float(kernelSize), position.z, 0.0, "
+              "1.0);\n";
+
+    vtkShaderProgram::Substitute(FSSource, "//VTK::FSQ::Impl", ssImpl.str());
+
+    this->SSAOQuadHelper = std::make_shared<vtkOpenGLQuadHelper>(renWin,
+      vtkOpenGLRenderUtilities::GetFullScreenQuadVertexShader().c_str(), FSSource.c_str(), "");
+
+    this->SSAOQuadHelper->ShaderChangeValue = this->GetMTime();
+  }
+  else
+  {
+    renWin->GetShaderCache()->ReadyShaderProgram(this->SSAOQuadHelper->Program);
+  }
+
+  if (!this->SSAOQuadHelper->Program || !this->SSAOQuadHelper->Program->GetCompiled())
+  {
+    vtkErrorMacro("Couldn't build the SSAO shader program.");
+    return;
+  }
+
+  vtkOpenGLState* ostate = renWin->GetState();
+
+  this->FrameBufferObject->Bind();
+  this->FrameBufferObject->AddColorAttachment(0, this->SSAOTexture);
+  this->FrameBufferObject->RemoveColorAttachment(1);
+  this->FrameBufferObject->RemoveColorAttachment(2);
+  this->FrameBufferObject->ActivateDrawBuffers(1);
+  this->FrameBufferObject->RemoveDepthAttachment();
+  this->FrameBufferObject->StartNonOrtho(sw, sh);
+
+  ostate->vtkglViewport(0, 0, sw, sh);
+  ostate->vtkglScissor(0, 0, sw, sh);
+  ostate->vtkglDisable(GL_DEPTH_TEST);
+  ostate->vtkglDisable(GL_BLEND);
+
+  vtkMatrix4x4* wcvc;
+  vtkMatrix3x3* norms;
+  vtkMatrix4x4* vcdc;
+  vtkMatrix4x4* wcdc;
+  vtkOpenGLCamera::SafeDownCast(ren->GetActiveCamera())
+    ->GetKeyMatrices(ren, wcvc, norms, vcdc, wcdc);
+
+  int kernelSize = std::min(this->Interactive ? this->InteractiveKernelSize : this->KernelSize,
+    this->ShaderKernelSize);
+
+  this->PositionTexture->Activate();
+  this->NormalTexture->Activate();
+
+  vtkShaderProgram* program = this->SSAOQuadHelper->Program;
+  program->SetUniformi("texPosition", this->PositionTexture->GetTextureUnit());
+  program->SetUniformi("texNormal", this->NormalTexture->GetTextureUnit());
+  program->SetUniform3fv(
+    "samples", kernelSize, reinterpret_cast<const float(*)[3]>(this->Kernel.data()));
+  program->SetUniformi("kernelSize", kernelSize);
+  program->SetUniformf("kernelRadius", static_cast<float>(this->Radius));
+  program->SetUniformf("kernelBias", static_cast<float>(this->Bias));
+  program->SetUniformMatrix("matProjection", vcdc);
+
+  this->SSAOQuadHelper->Render();
+
+  this->PositionTexture->Deactivate();
+  this->NormalTexture->Deactivate();
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DSSAOPass::RenderCombine(vtkOpenGLRenderWindow* renWin)
+{
+  if (!this->CombineQuadHelper)
+  {
+    std::string FSSource = vtkOpenGLRenderUtilities::GetFullScreenQuadFragmentShaderTemplate();
+
+    vtkShaderProgram::Substitute(FSSource, "//VTK::FSQ::Decl",
+      "uniform sampler2D texColor;\n"
+      "uniform sampler2D texPosition;\n"
+      "uniform sampler2D texDepth;\n"
+      "uniform sampler2D texSSAO;\n"
+      "//VTK::FSQ::Decl");
+
+    // Depth-aware upsampling: the ambient occlusion of the 4x4 closest texels is averaged,
+    // weighted by the relative depth difference with the full resolution pixel
+    vtkShaderProgram::Substitute(FSSource, "//VTK::FSQ::Impl",
+      "  float depth = texture(texDepth, texCoord).r;\n"
+      "  if (depth == 1.0)\n"
+      "  {\n"
+      "    // keep the background\n"
+      "    discard;\n"
+      "  }\n"
+      "  vec4 color = texture(texColor, texCoord);\n"
+      "  vec4 position = texture(texPosition, texCoord);\n"
+      "  float ao = 1.0;\n"
+      "  if (position.w > 0.0)\n"
+      "  {\n"
+      "    ivec2 ssaoSize = textureSize(texSSAO, 0);\n"
+      "    ivec2 base = ivec2(floor(texCoord * vec2(ssaoSize) - 0.5));\n"
+      "    float sum = 0.0;\n"
+      "    float weights = 0.0;\n"
+      "    for (int j = -1; j <= 2; j++)\n"
+      "    {\n"
+      "      for (int i = -1; i <= 2; i++)\n"
+      "      {\n"
+      "        ivec2 coord = clamp(base + ivec2(i, j), ivec2(0), ssaoSize - 1);\n"
+      "        vec2 ssao = texelFetch(texSSAO, coord, 0).rg;\n"
+      "        float weight = 1.0 / (0.001 + abs(position.z - ssao.g) / abs(position.z));\n"
+      "        sum += weight * ssao.r;\n"
+      "        weights += weight;\n"
+      "      }\n"
+      "    }\n"
+      "    ao = sum / weights;\n"
+      "  }\n"
+      "  gl_FragData[0] = vec4(color.rgb * ao, color.a);\n"
+      "  gl_FragDepth = depth;\n");
+
+    this->CombineQuadHelper = std::make_shared<vtkOpenGLQuadHelper>(renWin,
+      vtkOpenGLRenderUtilities::GetFullScreenQuadVertexShader().c_str(), FSSource.c_str(), "");
+  }
+  else
+  {
+    renWin->GetShaderCache()->ReadyShaderProgram(this->CombineQuadHelper->Program);
+  }
+
+  if (!this->CombineQuadHelper->Program || !this->CombineQuadHelper->Program->GetCompiled())
+  {
+    vtkErrorMacro("Couldn't build the SSAO combine shader program.");
+    return;
+  }
+
+  vtkOpenGLState* ostate = renWin->GetState();
+  ostate->vtkglEnable(GL_DEPTH_TEST);
+  ostate->vtkglDepthFunc(GL_ALWAYS);
+  ostate->vtkglDepthMask(GL_TRUE);
+  ostate->vtkglDisable(GL_BLEND);
+
+  this->ColorTexture->Activate();
+  this->PositionTexture->Activate();
+  this->DepthTexture->Activate();
+  this->SSAOTexture->Activate();
+
+  vtkShaderProgram* program = this->CombineQuadHelper->Program;
+  program->SetUniformi("texColor", this->ColorTexture->GetTextureUnit());
+  program->SetUniformi("texPosition", this->PositionTexture->GetTextureUnit());
+  program->SetUniformi("texDepth", this->DepthTexture->GetTextureUnit());
+  program->SetUniformi("texSSAO", this->SSAOTexture->GetTextureUnit());
+
+  this->CombineQuadHelper->Render();
+
+  this->ColorTexture->Deactivate();
+  this->PositionTexture->Deactivate();
+  this->DepthTexture->Deactivate();
+  this->SSAOTexture->Deactivate();
+
+  ostate->vtkglDepthFunc(GL_LEQUAL);
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DSSAOPass::BeginTiming()
+{
+  Timing& timing = this->Timings[this->Interactive ? 1 : 0];
+  this->CurrentTiming = nullptr;
+
+  if (timing.Queries[0] == 0)
+  {
+    glGenQueries(2, timing.Queries);
+  }
+
+  if (timing.Pending)
+  {
+    // the timestamps are written in order, so the first one is available with the last one
+    GLint available = 0;
+    glGetQueryObjectiv(timing.Queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+      // do not wait for the GPU, skip this frame
+      return;
+    }
+
+    GLuint64 start = 0;
+    GLuint64 end = 0;
+    glGetQueryObjectui64v(timing.Queries[0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(timing.Queries[1], GL_QUERY_RESULT, &end);
+    timing.TotalTime += (end - start) * 1e-6;
+    timing.Count++;
+    timing.Pending = false;
+  }
+
+  // timestamps do not nest with the elapsed time queries of the renderer, unlike GL_TIME_ELAPSED
+  glQueryCounter(timing.Queries[0], GL_TIMESTAMP);
+  this->CurrentTiming = &timing;
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DSSAOPass::EndTiming()
+{
+  if (this->CurrentTiming)
+  {
+    glQueryCounter(this->CurrentTiming->Queries[1], GL_TIMESTAMP);
+    this->CurrentTiming->Pending = true;
+    this->CurrentTiming = nullptr;
+  }
+}
+
+// ----------------------------------------------------------------------------
+bool vtkF3DSSAOPass::PostReplaceShaderValues(std::string& vtkNotUsed(vertexShader),
+  std::string& vtkNotUsed(geometryShader), std::string& fragmentShader,
+  vtkAbstractMapper* mapper, vtkProp* vtkNotUsed(prop))
+{
+  if (vtkOpenGLPolyDataMapper::SafeDownCast(mapper))
+  {
+    if (fragmentShader.find("vertexVC") != std::string::npos &&
+      fragmentShader.find("normalVCVSOutput") != std::string::npos)
+    {
+      vtkShaderProgram::Substitute(fragmentShader, "  //VTK::Light::Impl",
+        "  //VTK::Light::Impl\n"
+        "  if (gl_FragData[0].a > 0.0)\n"
+        "  {\n"
+        "    gl_FragData[1] = vec4(vertexVC.xyz, 1.0);\n"
+        "    gl_FragData[2] = vec4(normalVCVSOutput, 1.0);\n"
+        "  }\n"
+        "  else\n"
+        "  {\n"
+        "    gl_FragData[1] = vec4(0.0);\n"
+        "    gl_FragData[2] = vec4(0.0);\n"
+        "  }\n",
+        false);
+    }
+    else
+    {
+      vtkShaderProgram::Substitute(fragmentShader, "  //VTK::Light::Impl",
+        "  //VTK::Light::Impl\n"
+        "  gl_FragData[1] = vec4(0.0);\n"
+        "  gl_FragData[2] = vec4(0.0);\n",
+        false);
+    }
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+void vtkF3DSSAOPass::ReleaseGraphicsResources(vtkWindow* w)
+{
+  this->Superclass::ReleaseGraphicsResources(w);
+
+  if (this->SSAOQuadHelper)
+  {
+    this->SSAOQuadHelper->ReleaseGraphicsResources(w);
+    this->SSAOQuadHelper = nullptr;
+  }
+  if (this->CombineQuadHelper)
+  {
+    this->CombineQuadHelper->ReleaseGraphicsResources(w);
+    this->CombineQuadHelper = nullptr;
+  }
+
+  for (vtkTextureObject* texture : { this->ColorTexture.GetPointer(),
+         this->PositionTexture.GetPointer(), this->NormalTexture.GetPointer(),
+         this->DepthTexture.GetPointer(), this->SSAOTexture.GetPointer() })
+  {
+    if (texture)
+    {
+      texture->ReleaseGraphicsResources(w);
+    }
+  }
+  this->ColorTexture = nullptr;
+  this->PositionTexture = nullptr;
+  this->NormalTexture = nullptr;
+  this->DepthTexture = nullptr;
+  this->SSAOTexture = nullptr;
+
+  if (this->FrameBufferObject)
+  {
+    this->FrameBufferObject->ReleaseGraphicsResources(w);
+    this->FrameBufferObject = nullptr;
+  }
+
+  for (Timing& timing : this->Timings)
+  {
+    if (timing.Queries[0] != 0)
+    {
+      glDeleteQueries(2, timing.Queries);
+    }
+    timing = Timing();
+  }
+  this->CurrentTiming = nullptr;
+}
@@ -0,0 +1,153 @@
+/**
+ * @class   vtkF3DSSAOPass
+ * @brief   Screen-Space Ambient Occlusion pass computed at a reduced resolution
+ *
+ * vtkF3DSSAOPass renders the delegate pass into color, position, normal and depth textures,
+ * computes the ambient occlusion in a texture smaller than the viewport, then upsamples it
+ * using the depth of the full resolution image to avoid bleeding over the silhouettes.
+ * The number of samples of the kernel can be reduced while the user is interacting,
+ * the full kernel being used as soon as the interaction stops.
+ * The GPU time spent computing the ambient occlusion is measured for both modes.
+ *
+ * @sa
+ * vtkSSAOPass
+ */
+
+#ifndef vtkF3DSSAOPass_h
+#define vtkF3DSSAOPass_h
+
+#include <vtkImageProcessingPass.h>
+#include <vtkSmartPointer.h>
+
+#include <memory>
+#include <vector>
+
+class vtkOpenGLFramebufferObject;
+class vtkOpenGLQuadHelper;
+class vtkOpenGLRenderWindow;
+class vtkTextureObject;
+
+class vtkF3DSSAOPass : public vtkImageProcessingPass
+{
+public:
+  static vtkF3DSSAOPass* New();
+  vtkTypeMacro(vtkF3DSSAOPass, vtkImageProcessingPass);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  void Render(const vtkRenderState* s) override;
+
+  void ReleaseGraphicsResources(vtkWindow* w) override;
+
+  /**
+   * Write the view coordinates positions and normals in the additional render targets
+   */
+  bool PostReplaceShaderValues(std::string& vertexShader, std::string& geometryShader,
+    std::string& fragmentShader, vtkAbstractMapper* mapper, vtkProp* prop) override;
+
+  //@{
+  /**
+   * Set/Get the radius and the bias of the sampling hemisphere, in world units
+   */
+  vtkGetMacro(Radius, double);
+  vtkSetMacro(Radius, double);
+  vtkGetMacro(Bias, double);
+  vtkSetMacro(Bias, double);
+  //@}
+
+  //@{
+  /**
+   * Set/Get the number of samples used when the user is not interacting.
+   * The samples used are limited by the number of uniform vectors of the fragment shaders.
+   */
+  vtkGetMacro(KernelSize, int);
+  vtkSetClampMacro(KernelSize, int, 1, VTK_INT_MAX);
+  //@}
+
+  //@{
+  /**
+   * Set/Get the number of samples used when the user is interacting
+   */
+  vtkGetMacro(InteractiveKernelSize, int);
+  vtkSetClampMacro(InteractiveKernelSize, int, 1, VTK_INT_MAX);
+  //@}
+
+  //@{
+  /**
+   * Set/Get the resolution of the ambient occlusion texture, relative to the viewport size
+   */
+  vtkGetMacro(ResolutionScale, double);
+  vtkSetClampMacro(ResolutionScale, double, 0.1, 1.0);
+  //@}
+
+  //@{
+  /**
+   * Set/Get whether the user is interacting.
+   * Changing it does not modify the pass, since it only changes the number of samples used.
+   */
+  void SetInteractive(bool interactive) { this->Interactive = interactive; }
+  bool GetInteractive() { return this->Interactive; }
+  //@}
+
+  /**
+   * Get the average GPU time in milliseconds spent computing the ambient occlusion,
+   * when the user is interacting or not. Returns 0 if no measure is available yet.
+   */
+  double GetAverageTime(bool interactive);
+
+protected:
+  vtkF3DSSAOPass() = default;
+  ~vtkF3DSSAOPass() override;
+
+  void InitializeGraphicsResources(vtkOpenGLRenderWindow* renWin, int w, int h, int sw, int sh);
+  void ComputeKernel();
+
+  void RenderDelegate(const vtkRenderState* s, int w, int h);
+  void RenderSSAO(vtkOpenGLRenderWindow* renWin, vtkRenderer* ren, int sw, int sh);
+  void RenderCombine(vtkOpenGLRenderWindow* renWin);
+
+  //@{
+  /**
+   * Measure the GPU time of the ambient occlusion without stalling the pipeline:
+   * the results of a pair of timestamp queries are only read once available, and no new
+   * query is issued in the meantime.
+   */
+  void BeginTiming();
+  void EndTiming();
+  //@}
+
+  double Radius = 0.5;
+  double Bias = 0.01;
+  int KernelSize = 64;
+  int InteractiveKernelSize = 16;
+  int ShaderKernelSize = 0;
+  double ResolutionScale = 0.5;
+  bool Interactive = false;
+
+  std::vector<float> Kernel;
+
+  vtkSmartPointer<vtkOpenGLFramebufferObject> FrameBufferObject;
+  vtkSmartPointer<vtkTextureObject> ColorTexture;
+  vtkSmartPointer<vtkTextureObject> PositionTexture;
+  vtkSmartPointer<vtkTextureObject> NormalTexture;
+  vtkSmartPointer<vtkTextureObject> DepthTexture;
+  vtkSmartPointer<vtkTextureObject> SSAOTexture;
+
+  std::shared_ptr<vtkOpenGLQuadHelper> SSAOQuadHelper;
+  std::shared_ptr<vtkOpenGLQuadHelper> CombineQuadHelper;
+
+  struct Timing
+  {
+    unsigned int Queries[2] = { 0, 0 };
+    bool Pending = false;
+    double TotalTime = 0.0;
+    int Count = 0;
+  };
+  Timing Timings[2];
+  Timing* CurrentTiming = nullptr;
+
+private:
+  vtkF3DSSAOPass(const vtkF3DSSAOPass&) = delete;
+  void operator=(const vtkF3DSSAOPass&) = delete;
+};
+
+#endif
@@ -0,0 +1,273 @@
+#include "vtkF3DShaderCache.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkOpenGLState.h>
+#include <vtkShader.h>
+#include <vtkShaderProgram.h>
+#include <vtkVersion.h>
+#include <vtk_glew.h>
+#include <vtksys/FStream.hxx>
+#include <vtksys/MD5.h>
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+vtkStandardNewMacro(vtkF3DShaderCache);
+
+namespace
+{
+// Neither the shader program handle nor the shader cache of a window can be set through the
+// public API. Pointers to these protected members can be formed from a derived class though.
+struct ShaderProgramAccess : public vtkShaderProgram
+{
+  static void SetLinkedHandle(vtkShaderProgram* program, int handle)
+  {
+    program->*(&ShaderProgramAccess::Handle) = handle;
+    program->*(&ShaderProgramAccess::Linked) = true;
+  }
+};
+
+// The shader cache moved from the render window to the OpenGL state
+#if VTK_VERSION_NUMBER >= VTK_VERSION_CHECK(9, 0, 20201029)
+struct ShaderCacheOwnerAccess : public vtkOpenGLState
+{
+  static vtkOpenGLShaderCache*& ShaderCache(vtkOpenGLRenderWindow* renWin)
+  {
+    vtkOpenGLState* state = renWin->GetState();
+    return state->*(&ShaderCacheOwnerAccess::ShaderCache);
+  }
+};
+#else
+struct ShaderCacheOwnerAccess : public vtkOpenGLRenderWindow
+{
+  static vtkOpenGLShaderCache*& ShaderCache(vtkOpenGLRenderWindow* renWin)
+  {
+    return renWin->*(&ShaderCacheOwnerAccess::ShaderCache);
+  }
+};
+#endif
+
+// header of the cache files
+constexpr char FileMagic[4] = { 'F', '3', 'D', 'S' };
+struct FileHeader
+{
+  char Magic[4];
+  unsigned int Format;
+  double CompileTime;
+};
+
+std::string ComputeMD5(const std::vector<std::string>& contents)
+{
+  vtksysMD5* md5 = vtksysMD5_New();
+  vtksysMD5_Initialize(md5);
+  for (const std::string& content : contents)
+  {
+    vtksysMD5_Append(md5, reinterpret_cast<const unsigned char*>(content.c_str()),
+      static_cast<int>(content.size()));
+  }
+  char hash[32];
+  vtksysMD5_FinalizeHex(md5, hash);
+  vtksysMD5_Delete(md5);
+  return std::string(hash, 32);
+}
+
+std::string GetGLString(GLenum name)
+{
+  const GLubyte* str = glGetString(name);
+  return str ? reinterpret_cast<const char*>(str) : "";
+}
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DShaderCache::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Directory: " << this->Directory << "\n";
+  os << indent << "NumberOfHits: " << this->NumberOfHits << "\n";
+  os << indent << "NumberOfMisses: " << this->NumberOfMisses << "\n";
+  os << indent << "CompileTime: " << this->CompileTime << "\n";
+  os << indent << "SavedTime: " << this->SavedTime << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkF3DShaderCache* vtkF3DShaderCache::Install(
+  vtkRenderWindow* renWin, const std::string& directory)
+{
+  vtkOpenGLRenderWindow* glRenWin = vtkOpenGLRenderWindow::SafeDownCast(renWin);
+  if (!glRenWin)
+  {
+    return nullptr;
+  }
+
+  vtkF3DShaderCache* cache = vtkF3DShaderCache::New();
+  cache->SetDirectory(directory);
+
+  vtkOpenGLShaderCache*& currentCache = ShaderCacheOwnerAccess::ShaderCache(glRenWin);
+  if (currentCache)
+  {
+    currentCache->Delete();
+  }
+  currentCache = cache;
+
+  return cache;
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DShaderCache::IsSupported()
+{
+  if (this->Supported < 0)
+  {
+    GLint nbFormats = 0;
+    if (glGetProgramBinary && glProgramBinary)
+    {
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &nbFormats);
+    }
+    this->Supported = (nbFormats > 0 && !this->Directory.empty()) ? 1 : 0;
+
+    if (this->Supported)
+    {
+      this->DriverKey = GetGLString(GL_VENDOR) + GetGLString(GL_RENDERER) +
+        GetGLString(GL_VERSION) + vtkVersion::GetVTKVersion();
+      vtksys::SystemTools::MakeDirectory(this->Directory);
+    }
+  }
+  return this->Supported == 1;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkF3DShaderCache::GetProgramFileName(vtkShaderProgram* program)
+{
+  std::string hash = ComputeMD5({ this->DriverKey, program->GetVertexShader()->GetSource(),
+    program->GetFragmentShader()->GetSource(), program->GetGeometryShader()->GetSource() });
+  return vtksys::SystemTools::CollapseFullPath(hash + ".bin", this->Directory);
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DShaderCache::LoadProgram(vtkShaderProgram* program, const std::string& fileName)
+{
+  vtksys::ifstream file(fileName.c_str(), std::ios::binary | std::ios::ate);
+  if (!file.is_open())
+  {
+    return false;
+  }
+
+  std::streamoff size = static_cast<std::streamoff>(file.tellg());
+  if (size <= static_cast<std::streamoff>(sizeof(FileHeader)))
+  {
+    return false;
+  }
+  file.seekg(0);
+
+  FileHeader header;
+  std::vector<char> binary(static_cast<size_t>(size) - sizeof(FileHeader));
+  file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+  file.read(binary.data(), binary.size());
+  if (!file || std::memcmp(header.Magic, FileMagic, sizeof(FileMagic)) != 0)
+  {
+    return false;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  GLuint handle = glCreateProgram();
+  glProgramBinary(handle, header.Format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+  // the driver can reject a binary, it is compiled again in that case
+  GLint linked = GL_FALSE;
+  glGetProgramiv(handle, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE)
+  {
+    glDeleteProgram(handle);
+    return false;
+  }
+
+  ShaderProgramAccess::SetLinkedHandle(program, static_cast<int>(handle));
+  program->SetCompiled(true);
+
+  std::chrono::duration<double, std::milli> loadTime = std::chrono::steady_clock::now() - start;
+  this->SavedTime += std::max(0.0, header.CompileTime - loadTime.count());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DShaderCache::SaveProgram(
+  vtkShaderProgram* program, const std::string& fileName, double compileTime)
+{
+  GLuint handle = static_cast<GLuint>(program->GetHandle());
+  GLint length = 0;
+  glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+  {
+    return;
+  }
+
+  std::vector<char> binary(static_cast<size_t>(length));
+  GLenum format = 0;
+  glGetProgramBinary(handle, length, &length, &format, binary.data());
+  if (length <= 0)
+  {
+    return;
+  }
+
+  FileHeader header;
+  std::memcpy(header.Magic, FileMagic, sizeof(FileMagic));
+  header.Format = format;
+  header.CompileTime = compileTime;
+
+  // write in a temporary file first so another process never reads a partial file
+  std::string tmpFileName = fileName + ".tmp";
+  {
+    vtksys::ofstream file(tmpFileName.c_str(), std::ios::binary);
+    if (!file.is_open())
+    {
+      return;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+    file.write(binary.data(), length);
+    if (!file)
+    {
+      file.close();
+      vtksys::SystemTools::RemoveFile(tmpFileName);
+      return;
+    }
+  }
+  vtksys::SystemTools::RenameFile(tmpFileName, fileName);
+}
+
+//----------------------------------------------------------------------------
+vtkShaderProgram* vtkF3DShaderCache::ReadyShaderProgram(
+  vtkShaderProgram* program, vtkTransformFeedback* cap)
+{
+  // programs using transform feedback are left to the superclass since the varyings
+  // must be set before linking
+  if (program && !program->GetCompiled() && !cap && !program->GetTransformFeedback() &&
+    this->IsSupported())
+  {
+    std::string fileName = this->GetProgramFileName(program);
+    if (this->LoadProgram(program, fileName))
+    {
+      this->NumberOfHits++;
+    }
+    else
+    {
+      auto start = std::chrono::steady_clock::now();
+      if (!program->CompileShader())
+      {
+        return nullptr;
+      }
+      std::chrono::duration<double, std::milli> compileTime =
+        std::chrono::steady_clock::now() - start;
+
+      this->NumberOfMisses++;
+      this->CompileTime += compileTime.count();
+      this->SaveProgram(program, fileName, compileTime.count());
+    }
+  }
+
+  return this->Superclass::ReadyShaderProgram(program, cap);
+}
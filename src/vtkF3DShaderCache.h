@@ -0,0 +1,95 @@
+/**
+ * @class   vtkF3DShaderCache
+ * @brief   Shader cache storing the linked programs on disk
+ *
+ * vtkF3DShaderCache is a vtkOpenGLShaderCache which saves the binary of each program it
+ * compiles in a directory, and loads it instead of compiling the sources the next time the
+ * same program is needed, even in another F3D process.
+ * The binaries are keyed by a hash of the shader sources and of the OpenGL vendor, renderer
+ * and version strings, so that a driver update does not reuse incompatible binaries.
+ * If the driver does not support program binaries, it behaves as vtkOpenGLShaderCache.
+ *
+ * @sa
+ * vtkOpenGLShaderCache
+ */
+
+#ifndef vtkF3DShaderCache_h
+#define vtkF3DShaderCache_h
+
+#include <vtkOpenGLShaderCache.h>
+
+#include <string>
+
+class vtkRenderWindow;
+
+class vtkF3DShaderCache : public vtkOpenGLShaderCache
+{
+public:
+  static vtkF3DShaderCache* New();
+  vtkTypeMacro(vtkF3DShaderCache, vtkOpenGLShaderCache);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /**
+   * Replace the shader cache of an OpenGL render window by a vtkF3DShaderCache using the provided
+   * directory. It must be called before the window is rendered.
+   * Returns the new cache, or nullptr if the window is not an OpenGL one.
+   */
+  static vtkF3DShaderCache* Install(vtkRenderWindow* renWin, const std::string& directory);
+
+  using Superclass::ReadyShaderProgram;
+
+  /**
+   * Load the program binary from the disk if available, otherwise compile the program
+   * and save its binary, then bind it
+   */
+  vtkShaderProgram* ReadyShaderProgram(
+    vtkShaderProgram* program, vtkTransformFeedback* cap = nullptr) override;
+
+  //@{
+  /**
+   * Set/Get the directory where the binaries are stored
+   */
+  vtkSetMacro(Directory, std::string);
+  vtkGetMacro(Directory, std::string);
+  //@}
+
+  //@{
+  /**
+   * Get the statistics of the cache: the number of programs loaded from the disk, the number of
+   * programs compiled, the time spent compiling them and the compilation time saved by the
+   * loaded programs, in milliseconds
+   */
+  vtkGetMacro(NumberOfHits, int);
+  vtkGetMacro(NumberOfMisses, int);
+  vtkGetMacro(CompileTime, double);
+  vtkGetMacro(SavedTime, double);
+  //@}
+
+protected:
+  vtkF3DShaderCache() = default;
+  ~vtkF3DShaderCache() override = default;
+
+  /**
+   * Check that the context supports program binaries, only once
+   */
+  bool IsSupported();
+
+  std::string GetProgramFileName(vtkShaderProgram* program);
+  bool LoadProgram(vtkShaderProgram* program, const std::string& fileName);
+  void SaveProgram(vtkShaderProgram* program, const std::string& fileName, double compileTime);
+
+  std::string Directory;
+  std::string DriverKey;
+  int Supported = -1;
+
+  int NumberOfHits = 0;
+  int NumberOfMisses = 0;
+  double CompileTime = 0.0;
+  double SavedTime = 0.0;
+
+private:
+  vtkF3DShaderCache(const vtkF3DShaderCache&) = delete;
+  void operator=(const vtkF3DShaderCache&) = delete;
+};
+
+#endif
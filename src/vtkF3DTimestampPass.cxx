@@ -0,0 +1,75 @@
+#include "vtkF3DTimestampPass.h"
+
+#include "vtkF3DGPUProfiler.h"
+
+#include <vtkObjectFactory.h>
+
+vtkStandardNewMacro(vtkF3DTimestampPass);
+
+//----------------------------------------------------------------------------
+vtkF3DTimestampPass::~vtkF3DTimestampPass() = default;
+
+//----------------------------------------------------------------------------
+void vtkF3DTimestampPass::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Section: " << this->Section << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DTimestampPass::Render(const vtkRenderState* s)
+{
+  this->NumberOfRenderedProps = 0;
+  if (this->DelegatePass)
+  {
+    this->DelegatePass->Render(s);
+    this->NumberOfRenderedProps = this->DelegatePass->GetNumberOfRenderedProps();
+  }
+
+  if (this->Profiler)
+  {
+    this->Profiler->Mark(this->Section);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DTimestampPass::ReleaseGraphicsResources(vtkWindow* w)
+{
+  if (this->DelegatePass)
+  {
+    this->DelegatePass->ReleaseGraphicsResources(w);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DTimestampPass::SetDelegatePass(vtkRenderPass* pass)
+{
+  if (this->DelegatePass != pass)
+  {
+    this->DelegatePass = pass;
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkRenderPass* vtkF3DTimestampPass::GetDelegatePass()
+{
+  return this->DelegatePass;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DTimestampPass::SetProfiler(vtkF3DGPUProfiler* profiler)
+{
+  if (this->Profiler != profiler)
+  {
+    this->Profiler = profiler;
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkF3DGPUProfiler* vtkF3DTimestampPass::GetProfiler()
+{
+  return this->Profiler;
+}
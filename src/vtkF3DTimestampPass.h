@@ -0,0 +1,70 @@
+/**
+ * @class   vtkF3DTimestampPass
+ * @brief   Render a delegate pass and mark the end of a profiled section
+ *
+ * vtkF3DTimestampPass renders its delegate pass, then records the end of a named section
+ * in a vtkF3DGPUProfiler if it is measuring the current frame.
+ *
+ * @sa
+ * vtkF3DGPUProfiler
+ */
+
+#ifndef vtkF3DTimestampPass_h
+#define vtkF3DTimestampPass_h
+
+#include <vtkRenderPass.h>
+#include <vtkSmartPointer.h>
+
+#include <string>
+
+class vtkF3DGPUProfiler;
+
+class vtkF3DTimestampPass : public vtkRenderPass
+{
+public:
+  static vtkF3DTimestampPass* New();
+  vtkTypeMacro(vtkF3DTimestampPass, vtkRenderPass);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  void Render(const vtkRenderState* s) override;
+
+  void ReleaseGraphicsResources(vtkWindow* w) override;
+
+  //@{
+  /**
+   * Set/Get the pass rendered before marking the end of the section
+   */
+  void SetDelegatePass(vtkRenderPass* pass);
+  vtkRenderPass* GetDelegatePass();
+  //@}
+
+  //@{
+  /**
+   * Set/Get the profiler, nothing is recorded if nullptr
+   */
+  void SetProfiler(vtkF3DGPUProfiler* profiler);
+  vtkF3DGPUProfiler* GetProfiler();
+  //@}
+
+  //@{
+  /**
+   * Set/Get the name of the section
+   */
+  vtkSetMacro(Section, std::string);
+  vtkGetMacro(Section, std::string);
+  //@}
+
+protected:
+  vtkF3DTimestampPass() = default;
+  ~vtkF3DTimestampPass() override;
+
+  vtkSmartPointer<vtkRenderPass> DelegatePass;
+  vtkSmartPointer<vtkF3DGPUProfiler> Profiler;
+  std::string Section;
+
+private:
+  vtkF3DTimestampPass(const vtkF3DTimestampPass&) = delete;
+  void operator=(const vtkF3DTimestampPass&) = delete;
+};
+
+#endif
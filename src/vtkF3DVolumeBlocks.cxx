@@ -0,0 +1,206 @@
+#include "vtkF3DVolumeBlocks.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <cmath>
+
+vtkStandardNewMacro(vtkF3DVolumeBlocks);
+
+namespace
+{
+// Number of values of a block along each axis, without the shared boundary
+constexpr int BlockSize = 16;
+
+// Range of the values of a block along an axis, the last value being included
+void GetBlockRange(int block, int dimension, bool cellData, int& first, int& last)
+{
+  first = block * ::BlockSize;
+  last = cellData ? std::min(first + ::BlockSize, dimension) - 1
+                  : std::min(first + ::BlockSize, dimension - 1);
+}
+
+template <class T>
+void ComputeRanges(const T* data, int nbComponents, int component, const int dims[3],
+  const int counts[3], bool cellData, std::vector<double>& ranges)
+{
+  vtkIdType nbBlocks = static_cast<vtkIdType>(counts[0]) * counts[1] * counts[2];
+  vtkSMPTools::For(0, nbBlocks, [&](vtkIdType firstBlock, vtkIdType lastBlock) {
+    for (vtkIdType block = firstBlock; block < lastBlock; block++)
+    {
+      int first[3];
+      int last[3];
+      vtkIdType index = block;
+      for (int c = 0; c < 3; c++)
+      {
+        ::GetBlockRange(static_cast<int>(index % counts[c]), dims[c], cellData, first[c], last[c]);
+        index /= counts[c];
+      }
+
+      double min = VTK_DOUBLE_MAX;
+      double max = VTK_DOUBLE_MIN;
+      for (int k = first[2]; k <= last[2]; k++)
+      {
+        for (int j = first[1]; j <= last[1]; j++)
+        {
+          vtkIdType tuple = (static_cast<vtkIdType>(k) * dims[1] + j) * dims[0] + first[0];
+          const T* values = data + tuple * nbComponents;
+          for (int i = first[0]; i <= last[0]; i++, values += nbComponents)
+          {
+            double value;
+            if (component >= 0)
+            {
+              value = static_cast<double>(values[component]);
+            }
+            else
+            {
+              value = 0.0;
+              for (int comp = 0; comp < nbComponents; comp++)
+              {
+                double v = static_cast<double>(values[comp]);
+                value += v * v;
+              }
+              value = std::sqrt(value);
+            }
+            min = std::min(min, value);
+            max = std::max(max, value);
+          }
+        }
+      }
+      ranges[2 * block] = min;
+      ranges[2 * block + 1] = max;
+    }
+  });
+}
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DVolumeBlocks::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfBlocks: " << this->GetNumberOfBlocks() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DVolumeBlocks::Build(vtkImageData* image, vtkDataArray* array, int component)
+{
+  this->Ranges.clear();
+  this->Modified();
+
+  if (!image || !array || component >= array->GetNumberOfComponents())
+  {
+    return;
+  }
+
+  image->GetExtent(this->Extent);
+  this->CellData = array->GetNumberOfTuples() != image->GetNumberOfPoints();
+  vtkIdType nbValues = 1;
+  for (int c = 0; c < 3; c++)
+  {
+    int dimension = this->Extent[2 * c + 1] - this->Extent[2 * c] + 1;
+    this->Dimensions[c] = this->CellData ? std::max(dimension - 1, 1) : dimension;
+    this->Counts[c] = this->CellData
+      ? (this->Dimensions[c] + ::BlockSize - 1) / ::BlockSize
+      : std::max((this->Dimensions[c] - 1 + ::BlockSize - 1) / ::BlockSize, 1);
+    nbValues *= this->Dimensions[c];
+  }
+  if (nbValues != array->GetNumberOfTuples())
+  {
+    return;
+  }
+
+  this->Ranges.resize(2 * static_cast<size_t>(this->Counts[0]) * this->Counts[1] * this->Counts[2]);
+  switch (array->GetDataType())
+  {
+    vtkTemplateMacro(::ComputeRanges(static_cast<const VTK_TT*>(array->GetVoidPointer(0)),
+      array->GetNumberOfComponents(), component, this->Dimensions, this->Counts, this->CellData,
+      this->Ranges));
+    default:
+      this->Ranges.clear();
+      break;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkF3DVolumeBlocks::GetOccupiedExtent(vtkPiecewiseFunction* opacity, int extent[6]) const
+{
+  if (this->Ranges.empty() || !opacity)
+  {
+    return false;
+  }
+
+  // the function is linear between its nodes, so its maximum on a range is at the bounds
+  // of the range or at a node inside it
+  std::vector<double> nodes(4 * opacity->GetSize());
+  for (int i = 0; i < opacity->GetSize(); i++)
+  {
+    opacity->GetNodeValue(i, nodes.data() + 4 * i);
+  }
+  auto isEmpty = [&](double min, double max) {
+    if (opacity->GetValue(min) > 0.0 || opacity->GetValue(max) > 0.0)
+    {
+      return false;
+    }
+    for (size_t i = 0; i < nodes.size(); i += 4)
+    {
+      if (nodes[i] > min && nodes[i] < max && nodes[i + 1] > 0.0)
+      {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  int occupied[6] = { VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX,
+    VTK_INT_MIN };
+  vtkIdType block = 0;
+  for (int k = 0; k < this->Counts[2]; k++)
+  {
+    for (int j = 0; j < this->Counts[1]; j++)
+    {
+      for (int i = 0; i < this->Counts[0]; i++, block++)
+      {
+        if (isEmpty(this->Ranges[2 * block], this->Ranges[2 * block + 1]))
+        {
+          continue;
+        }
+        int index[3] = { i, j, k };
+        for (int c = 0; c < 3; c++)
+        {
+          occupied[2 * c] = std::min(occupied[2 * c], index[c]);
+          occupied[2 * c + 1] = std::max(occupied[2 * c + 1], index[c]);
+        }
+      }
+    }
+  }
+  if (occupied[0] > occupied[1])
+  {
+    return false;
+  }
+
+  // a cell spans the points of its index and of the next index
+  for (int c = 0; c < 3; c++)
+  {
+    int first;
+    int last;
+    ::GetBlockRange(occupied[2 * c], this->Dimensions[c], this->CellData, first, last);
+    extent[2 * c] = this->Extent[2 * c] + first;
+    ::GetBlockRange(occupied[2 * c + 1], this->Dimensions[c], this->CellData, first, last);
+    extent[2 * c + 1] =
+      std::min(this->Extent[2 * c] + last + (this->CellData ? 1 : 0), this->Extent[2 * c + 1]);
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkF3DVolumeBlocks::GetNumberOfBlocks() const
+{
+  return this->Ranges.empty()
+    ? 0
+    : static_cast<vtkIdType>(this->Counts[0]) * this->Counts[1] * this->Counts[2];
+}
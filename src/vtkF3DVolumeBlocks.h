@@ -0,0 +1,76 @@
+/**
+ * @class   vtkF3DVolumeBlocks
+ * @brief   Min/max blocks of the values of an image
+ *
+ * vtkF3DVolumeBlocks splits an image into blocks of voxels and stores the range of the
+ * rendered values in each of them, a component or the magnitude of an array, computed in
+ * parallel using vtkSMPTools.
+ * With an opacity function, a block whose range only maps to a null opacity is empty, and
+ * rays do not need to go through it. Since the blocks share their boundary voxels, the values
+ * interpolated in a block stay in its range.
+ * The ranges are only computed by Build, so that classifying the blocks for another opacity
+ * function is cheap.
+ *
+ * @sa
+ * vtkF3DVolumeLODMapper
+ */
+
+#ifndef vtkF3DVolumeBlocks_h
+#define vtkF3DVolumeBlocks_h
+
+#include <vtkObject.h>
+
+#include <vector>
+
+class vtkDataArray;
+class vtkImageData;
+class vtkPiecewiseFunction;
+
+class vtkF3DVolumeBlocks : public vtkObject
+{
+public:
+  static vtkF3DVolumeBlocks* New();
+  vtkTypeMacro(vtkF3DVolumeBlocks, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /**
+   * Compute the ranges of the blocks of a point or cell array of the image,
+   * using a component of the array, or its magnitude when component is -1
+   */
+  void Build(vtkImageData* image, vtkDataArray* array, int component);
+
+  /**
+   * Get the extent of the points of the image containing all the blocks that are not empty
+   * with the opacity function. Return false if all the blocks are empty or if not built.
+   */
+  bool GetOccupiedExtent(vtkPiecewiseFunction* opacity, int extent[6]) const;
+
+  /**
+   * Get the number of blocks, or 0 if not built
+   */
+  vtkIdType GetNumberOfBlocks() const;
+
+protected:
+  vtkF3DVolumeBlocks() = default;
+  ~vtkF3DVolumeBlocks() override = default;
+
+  // extent of the points of the image
+  int Extent[6] = { 0, -1, 0, -1, 0, -1 };
+
+  // number of values of the array along each axis
+  int Dimensions[3] = { 0, 0, 0 };
+
+  // number of blocks along each axis
+  int Counts[3] = { 0, 0, 0 };
+
+  bool CellData = false;
+
+  // min and max of each block, x varying first
+  std::vector<double> Ranges;
+
+private:
+  vtkF3DVolumeBlocks(const vtkF3DVolumeBlocks&) = delete;
+  void operator=(const vtkF3DVolumeBlocks&) = delete;
+};
+
+#endif
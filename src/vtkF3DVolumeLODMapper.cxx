@@ -0,0 +1,478 @@
+#include "vtkF3DVolumeLODMapper.h"
+
+#include "vtkF3DVolumeBlocks.h"
+
+#include <vtkCamera.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkExtractVOI.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix3x3.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkPointData.h>
+#include <vtkRenderer.h>
+#include <vtkVolume.h>
+#include <vtkVolumeProperty.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+vtkStandardNewMacro(vtkF3DVolumeLODMapper);
+
+namespace
+{
+// Maximum number of bricks along each axis
+constexpr int BricksPerAxis = 8;
+
+// Maximum level of the pyramid, a level being subsampled by two from the previous one
+constexpr int MaxLevel = 16;
+
+// Number of voxels of an extent of the input subsampled at the given level
+double GetNumberOfVoxels(const int extent[6], int level)
+{
+  double count = 1.0;
+  for (int c = 0; c < 3; c++)
+  {
+    count *= ((extent[2 * c + 1] - extent[2 * c]) >> level) + 1;
+  }
+  return count;
+}
+
+// Test the bounds against the frustum planes, whose normals point inward
+bool IsInFrustum(const double planes[24], const double bounds[6])
+{
+  for (int i = 0; i < 6; i++)
+  {
+    const double* plane = planes + 4 * i;
+    double value = plane[3];
+    for (int c = 0; c < 3; c++)
+    {
+      value += plane[c] * (plane[c] >= 0.0 ? bounds[2 * c + 1] : bounds[2 * c]);
+    }
+    if (value < 0.0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// World bounds of an extent of the image rendered by the volume
+void GetWorldBounds(
+  vtkImageData* image, vtkMatrix4x4* matrix, const int extent[6], double bounds[6])
+{
+  vtkMath::UninitializeBounds(bounds);
+  for (int corner = 0; corner < 8; corner++)
+  {
+    double index[3];
+    for (int c = 0; c < 3; c++)
+    {
+      index[c] = extent[2 * c + ((corner >> c) & 1)];
+    }
+    double point[4] = { 0.0, 0.0, 0.0, 1.0 };
+    image->TransformContinuousIndexToPhysicalPoint(index, point);
+    matrix->MultiplyPoint(point, point);
+    for (int c = 0; c < 3; c++)
+    {
+      bounds[2 * c] = corner == 0 ? point[c] : std::min(bounds[2 * c], point[c]);
+      bounds[2 * c + 1] = corner == 0 ? point[c] : std::max(bounds[2 * c + 1], point[c]);
+    }
+  }
+}
+
+// Squared distance between a position and bounds
+double GetDistance2(const double position[3], const double bounds[6])
+{
+  double distance2 = 0.0;
+  for (int c = 0; c < 3; c++)
+  {
+    double d = std::max({ bounds[2 * c] - position[c], position[c] - bounds[2 * c + 1], 0.0 });
+    distance2 += d * d;
+  }
+  return distance2;
+}
+}
+
+//----------------------------------------------------------------------------
+vtkF3DVolumeLODMapper::vtkF3DVolumeLODMapper()
+{
+  this->Blocks = vtkSmartPointer<vtkF3DVolumeBlocks>::New();
+}
+
+//----------------------------------------------------------------------------
+vtkF3DVolumeLODMapper::~vtkF3DVolumeLODMapper()
+{
+  if (this->ExtractionThread.joinable())
+  {
+    this->ExtractionThread.join();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DVolumeLODMapper::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "MemoryBudget: " << this->MemoryBudget << "\n";
+  os << indent << "Interactive: " << this->Interactive << "\n";
+  os << indent << "InteractiveSampleDistanceFactor: " << this->InteractiveSampleDistanceFactor
+     << "\n";
+  os << indent << "RenderedLevel: " << this->RenderedLevel << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DVolumeLODMapper::Render(vtkRenderer* ren, vtkVolume* vol)
+{
+  this->Update();
+  vtkImageData* input = vtkImageData::SafeDownCast(this->GetInput());
+  vtkDataArray* array = input ? this->GetRenderedArray(input) : nullptr;
+
+  // the GPU mapper uploads a single component unless rendering the scalars directly
+  double voxelSize = 0.0;
+  if (array)
+  {
+    int nbComponents = this->VectorMode == vtkSmartVolumeMapper::DISABLED
+      ? array->GetNumberOfComponents()
+      : 1;
+    voxelSize = static_cast<double>(array->GetDataTypeSize()) * nbComponents;
+  }
+  double budget = this->MemoryBudget * 1048576.0 / std::max(voxelSize, 1.0);
+
+  this->UpdateCropping(input, array, vol);
+
+  if (this->MemoryBudget <= 0 || !array || array->GetNumberOfTuples() <= budget)
+  {
+    this->RenderedLevel = 0;
+    this->UpdateSampleDistance(input);
+    this->Superclass::Render(ren, vol);
+    return;
+  }
+
+  if (input->GetMTime() > this->DisplayedTime)
+  {
+    this->CollectExtraction();
+    this->DisplayedTime.Modified();
+    this->DisplayedRegion = Region();
+    this->Delegate->SetInputData(nullptr);
+  }
+
+  // a background extraction is used as soon as it is available
+  if (this->PendingExtraction.valid() &&
+    (!this->Interactive ||
+      this->PendingExtraction.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+  {
+    this->CollectExtraction();
+  }
+
+  Region region = this->SelectRegion(ren, vol, input, budget);
+  if (region != this->DisplayedRegion)
+  {
+    if (!this->Interactive || !this->Delegate->GetInput())
+    {
+      Extraction extraction = vtkF3DVolumeLODMapper::ExtractRegion(input, region);
+      this->DisplayedRegion = extraction.Displayed;
+      this->Delegate->SetInputData(extraction.Image);
+    }
+    else if (!this->PendingExtraction.valid())
+    {
+      // the thread works on its own shallow copy of the input
+      vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+      image->ShallowCopy(input);
+
+      std::packaged_task<Extraction()> task(
+        [image, region]() { return vtkF3DVolumeLODMapper::ExtractRegion(image, region); });
+      this->PendingExtraction = task.get_future();
+      this->ExtractionThread = std::thread(std::move(task));
+    }
+  }
+
+  this->RenderedLevel = this->DisplayedRegion.Level;
+
+  this->UpdateSampleDistance(vtkImageData::SafeDownCast(this->Delegate->GetInput()));
+  this->UpdateDelegate();
+  this->Delegate->Render(ren, vol);
+}
+
+//----------------------------------------------------------------------------
+vtkDataArray* vtkF3DVolumeLODMapper::GetRenderedArray(vtkImageData* input)
+{
+  bool cellFlag = this->ScalarMode == VTK_SCALAR_MODE_USE_CELL_DATA ||
+    this->ScalarMode == VTK_SCALAR_MODE_USE_CELL_FIELD_DATA;
+  vtkDataSetAttributes* data = cellFlag
+    ? static_cast<vtkDataSetAttributes*>(input->GetCellData())
+    : static_cast<vtkDataSetAttributes*>(input->GetPointData());
+
+  vtkDataArray* array = nullptr;
+  if (this->ScalarMode == VTK_SCALAR_MODE_USE_POINT_FIELD_DATA ||
+    this->ScalarMode == VTK_SCALAR_MODE_USE_CELL_FIELD_DATA)
+  {
+    array = this->ArrayAccessMode == VTK_GET_ARRAY_BY_NAME
+      ? (this->ArrayName ? data->GetArray(this->ArrayName) : nullptr)
+      : data->GetArray(this->ArrayId);
+  }
+  return array ? array : data->GetScalars();
+}
+
+//----------------------------------------------------------------------------
+vtkF3DVolumeLODMapper::Region vtkF3DVolumeLODMapper::SelectRegion(
+  vtkRenderer* ren, vtkVolume* vol, vtkImageData* input, double budget)
+{
+  int extent[6];
+  input->GetExtent(extent);
+
+  // the coarsest level is the first one whose whole image fits in the budget
+  Region region;
+  std::copy(extent, extent + 6, region.Extent.begin());
+  while (region.Level < ::MaxLevel && ::GetNumberOfVoxels(extent, region.Level) > budget)
+  {
+    region.Level++;
+  }
+  int coarsestLevel = region.Level;
+
+  vtkCamera* camera = ren->GetActiveCamera();
+  double planes[24];
+  camera->GetFrustumPlanes(ren->GetTiledAspectRatio(), planes);
+  double position[3];
+  camera->GetPosition(position);
+
+  // the visible extent is the union of the bricks in the frustum
+  int visible[6] = { VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX,
+    VTK_INT_MIN };
+  double distance2 = VTK_DOUBLE_MAX;
+  int brickSize[3];
+  for (int c = 0; c < 3; c++)
+  {
+    brickSize[c] = std::max((extent[2 * c + 1] - extent[2 * c]) / ::BricksPerAxis, 1);
+  }
+  int brick[6];
+  for (brick[4] = extent[4]; brick[4] < extent[5] || brick[4] == extent[4];
+       brick[4] += brickSize[2])
+  {
+    brick[5] = std::min(brick[4] + brickSize[2], extent[5]);
+    for (brick[2] = extent[2]; brick[2] < extent[3] || brick[2] == extent[2];
+         brick[2] += brickSize[1])
+    {
+      brick[3] = std::min(brick[2] + brickSize[1], extent[3]);
+      for (brick[0] = extent[0]; brick[0] < extent[1] || brick[0] == extent[0];
+           brick[0] += brickSize[0])
+      {
+        brick[1] = std::min(brick[0] + brickSize[0], extent[1]);
+
+        double bounds[6];
+        ::GetWorldBounds(input, vol->GetMatrix(), brick, bounds);
+        if (!::IsInFrustum(planes, bounds))
+        {
+          continue;
+        }
+        distance2 = std::min(distance2, ::GetDistance2(position, bounds));
+        for (int c = 0; c < 3; c++)
+        {
+          visible[2 * c] = std::min(visible[2 * c], brick[2 * c]);
+          visible[2 * c + 1] = std::max(visible[2 * c + 1], brick[2 * c + 1]);
+        }
+      }
+    }
+  }
+
+  if (visible[0] > visible[1] || coarsestLevel == 0)
+  {
+    return region;
+  }
+
+  // finer levels than the one where a voxel covers a pixel add no detail
+  double* spacing = input->GetSpacing();
+  double voxelLength =
+    std::min({ std::abs(spacing[0]), std::abs(spacing[1]), std::abs(spacing[2]) });
+  double height = std::max(1, ren->GetSize()[1]);
+  double voxelPixels = VTK_DOUBLE_MAX;
+  if (camera->GetParallelProjection())
+  {
+    voxelPixels = voxelLength * height / (2.0 * camera->GetParallelScale());
+  }
+  else if (distance2 > 0.0)
+  {
+    double pixelsPerUnit =
+      height / (2.0 * std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0));
+    voxelPixels = voxelLength / std::sqrt(distance2) * pixelsPerUnit;
+  }
+  int level = voxelPixels < 1.0 ? static_cast<int>(std::log2(1.0 / voxelPixels)) : 0;
+
+  while (level < coarsestLevel && ::GetNumberOfVoxels(visible, level) > budget)
+  {
+    level++;
+  }
+  if (level >= coarsestLevel)
+  {
+    return region;
+  }
+
+  // align the extent on the subsampled voxels so that they do not move with the view
+  region.Level = level;
+  int rate = 1 << level;
+  for (int c = 0; c < 3; c++)
+  {
+    region.Extent[2 * c] = extent[2 * c] + (visible[2 * c] - extent[2 * c]) / rate * rate;
+    region.Extent[2 * c + 1] = visible[2 * c + 1];
+  }
+  return region;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DVolumeLODMapper::CollectExtraction()
+{
+  if (!this->PendingExtraction.valid())
+  {
+    return;
+  }
+
+  Extraction extraction = this->PendingExtraction.get();
+  this->ExtractionThread.join();
+
+  if (this->DisplayedTime < this->GetInput()->GetMTime())
+  {
+    // the extraction comes from a previous input
+    return;
+  }
+  this->DisplayedRegion = extraction.Displayed;
+  this->Delegate->SetInputData(extraction.Image);
+}
+
+//----------------------------------------------------------------------------
+vtkF3DVolumeLODMapper::Extraction vtkF3DVolumeLODMapper::ExtractRegion(
+  vtkImageData* input, const Region& region)
+{
+  int rate = 1 << region.Level;
+
+  vtkNew<vtkExtractVOI> voi;
+  voi->SetInputData(input);
+  voi->SetVOI(region.Extent[0], region.Extent[1], region.Extent[2], region.Extent[3],
+    region.Extent[4], region.Extent[5]);
+  voi->SetSampleRate(rate, rate, rate);
+  voi->IncludeBoundaryOn();
+  voi->Update();
+
+  Extraction extraction;
+  extraction.Displayed = region;
+  extraction.Image = vtkSmartPointer<vtkImageData>::New();
+  extraction.Image->ShallowCopy(voi->GetOutput());
+  return extraction;
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DVolumeLODMapper::UpdateCropping(
+  vtkImageData* input, vtkDataArray* array, vtkVolume* vol)
+{
+  // the opacity only depends on a single value when rendering a component or the magnitude
+  int component = -2;
+  if (this->VectorMode == vtkSmartVolumeMapper::COMPONENT)
+  {
+    component = this->VectorComponent;
+  }
+  else if (this->VectorMode == vtkSmartVolumeMapper::MAGNITUDE)
+  {
+    component = -1;
+  }
+  else if (array && array->GetNumberOfComponents() == 1)
+  {
+    component = 0;
+  }
+
+  // the cropping planes are aligned with the axes
+  vtkPiecewiseFunction* opacity = vol->GetProperty()->GetScalarOpacity();
+  if (!input || !array || component < -1 || !input->GetDirectionMatrix()->IsIdentity())
+  {
+    this->CroppingOff();
+    this->CroppingOpacity = nullptr;
+    return;
+  }
+
+  if (array != this->BlocksArray || component != this->BlocksComponent ||
+    array->GetMTime() > this->BlocksBuildTime || input->GetMTime() > this->BlocksBuildTime)
+  {
+    this->Blocks->Build(input, array, component);
+    this->BlocksBuildTime.Modified();
+    this->BlocksArray = array;
+    this->BlocksComponent = component;
+    this->CroppingOpacity = nullptr;
+  }
+
+  if (opacity == this->CroppingOpacity && opacity->GetMTime() <= this->CroppingTime)
+  {
+    return;
+  }
+  this->CroppingOpacity = opacity;
+  this->CroppingTime.Modified();
+
+  int extent[6];
+  int occupied[6];
+  input->GetExtent(extent);
+  if (!this->Blocks->GetOccupiedExtent(opacity, occupied) ||
+    std::equal(extent, extent + 6, occupied))
+  {
+    this->CroppingOff();
+    return;
+  }
+
+  double planes[6];
+  for (int c = 0; c < 3; c++)
+  {
+    double first = input->GetOrigin()[c] + occupied[2 * c] * input->GetSpacing()[c];
+    double last = input->GetOrigin()[c] + occupied[2 * c + 1] * input->GetSpacing()[c];
+    planes[2 * c] = std::min(first, last);
+    planes[2 * c + 1] = std::max(first, last);
+  }
+  this->SetCroppingRegionPlanes(planes);
+  this->SetCroppingRegionFlagsToSubVolume();
+  this->CroppingOn();
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DVolumeLODMapper::UpdateSampleDistance(vtkImageData* rendered)
+{
+  if (!this->Interactive || !rendered)
+  {
+    this->AutoAdjustSampleDistancesOn();
+    return;
+  }
+
+  double* spacing = rendered->GetSpacing();
+  double minSpacing =
+    std::min({ std::abs(spacing[0]), std::abs(spacing[1]), std::abs(spacing[2]) });
+  this->AutoAdjustSampleDistancesOff();
+  this->SetSampleDistance(static_cast<float>(this->InteractiveSampleDistanceFactor * minSpacing));
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DVolumeLODMapper::UpdateDelegate()
+{
+  // only modify the internal mapper when the parameters actually changed
+  this->Delegate->SetScalarMode(this->GetScalarMode());
+  if (this->GetArrayAccessMode() == VTK_GET_ARRAY_BY_NAME)
+  {
+    this->Delegate->SelectScalarArray(this->GetArrayName());
+  }
+  else
+  {
+    this->Delegate->SelectScalarArray(this->GetArrayId());
+  }
+  this->Delegate->SetVectorMode(this->GetVectorMode());
+  this->Delegate->SetVectorComponent(this->GetVectorComponent());
+  this->Delegate->SetRequestedRenderMode(this->GetRequestedRenderMode());
+  this->Delegate->SetBlendMode(this->GetBlendMode());
+  this->Delegate->SetAutoAdjustSampleDistances(this->GetAutoAdjustSampleDistances());
+  this->Delegate->SetSampleDistance(this->GetSampleDistance());
+  this->Delegate->SetCropping(this->GetCropping());
+  this->Delegate->SetCroppingRegionPlanes(this->GetCroppingRegionPlanes());
+  this->Delegate->SetCroppingRegionFlags(this->GetCroppingRegionFlags());
+}
+
+//----------------------------------------------------------------------------
+void vtkF3DVolumeLODMapper::ReleaseGraphicsResources(vtkWindow* w)
+{
+  this->Delegate->ReleaseGraphicsResources(w);
+  this->Superclass::ReleaseGraphicsResources(w);
+}
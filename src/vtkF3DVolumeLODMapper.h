@@ -0,0 +1,167 @@
+/**
+ * @class   vtkF3DVolumeLODMapper
+ * @brief   Smart volume mapper rendering an image within a memory budget
+ *
+ * vtkF3DVolumeLODMapper renders its input as vtkSmartVolumeMapper does when its rendered
+ * array fits in the memory budget. Otherwise, the image is seen as a pyramid of levels,
+ * each level being subsampled by two along each axis from the previous one, and split into
+ * bricks. Only the bricks in the view frustum are extracted, at the finest level fitting in
+ * the budget that is still useful at the current screen resolution, and they are rendered by
+ * an internal mapper using the same parameters. Zooming in thus refines the rendered bricks.
+ * While interacting, the bricks are extracted in a background thread and the previous
+ * extraction is rendered until they are available.
+ * In all cases, the rendering is cropped to the blocks of the image that are not empty with
+ * the opacity function of the volume, using vtkF3DVolumeBlocks, so that rays do not march
+ * through the transparent space around the data. The sample distance is also increased while
+ * interacting.
+ *
+ * @sa
+ * vtkF3DPointCloudLODMapper vtkF3DVolumeBlocks
+ */
+
+#ifndef vtkF3DVolumeLODMapper_h
+#define vtkF3DVolumeLODMapper_h
+
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkSmartVolumeMapper.h>
+
+#include <array>
+#include <future>
+#include <thread>
+
+class vtkDataArray;
+class vtkF3DVolumeBlocks;
+class vtkImageData;
+class vtkPiecewiseFunction;
+
+class vtkF3DVolumeLODMapper : public vtkSmartVolumeMapper
+{
+public:
+  static vtkF3DVolumeLODMapper* New();
+  vtkTypeMacro(vtkF3DVolumeLODMapper, vtkSmartVolumeMapper);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  void Render(vtkRenderer* ren, vtkVolume* vol) override;
+
+  void ReleaseGraphicsResources(vtkWindow* w) override;
+
+  //@{
+  /**
+   * Set/Get the maximum size in MiB of the rendered array.
+   * Default is 0, which renders the whole image.
+   */
+  vtkSetMacro(MemoryBudget, int);
+  vtkGetMacro(MemoryBudget, int);
+  //@}
+
+  //@{
+  /**
+   * Set/Get if the bricks are extracted in a background thread.
+   * Otherwise, the rendered bricks always match the view.
+   */
+  vtkSetMacro(Interactive, bool);
+  vtkGetMacro(Interactive, bool);
+  //@}
+
+  //@{
+  /**
+   * Set/Get the sample distance used while interacting, relative to the smallest spacing
+   * of the rendered image. When not interacting, the sample distance is adjusted
+   * automatically. Default is 2.
+   */
+  vtkSetMacro(InteractiveSampleDistanceFactor, double);
+  vtkGetMacro(InteractiveSampleDistanceFactor, double);
+  //@}
+
+  /**
+   * Get the pyramid level rendered by the last render, 0 being the full resolution
+   */
+  vtkGetMacro(RenderedLevel, int);
+
+protected:
+  vtkF3DVolumeLODMapper();
+  ~vtkF3DVolumeLODMapper() override;
+
+  /**
+   * Part of the pyramid to render, the extent being in the indices of the input
+   */
+  struct Region
+  {
+    int Level = 0;
+    std::array<int, 6> Extent = { { 0, -1, 0, -1, 0, -1 } };
+
+    bool operator==(const Region& other) const
+    {
+      return this->Level == other.Level && this->Extent == other.Extent;
+    }
+    bool operator!=(const Region& other) const { return !(*this == other); }
+  };
+
+  struct Extraction
+  {
+    Region Displayed;
+    vtkSmartPointer<vtkImageData> Image;
+  };
+
+  /**
+   * Get the array rendered by this mapper, if any
+   */
+  vtkDataArray* GetRenderedArray(vtkImageData* input);
+
+  /**
+   * Select the region of the input to render in the current view, within a budget in voxels
+   */
+  Region SelectRegion(vtkRenderer* ren, vtkVolume* vol, vtkImageData* input, double budget);
+
+  /**
+   * Extract a region of the input with its point and cell data, can run in any thread
+   */
+  static Extraction ExtractRegion(vtkImageData* input, const Region& region);
+
+  /**
+   * Wait for the background extraction if any and render its image
+   */
+  void CollectExtraction();
+
+  /**
+   * Crop the rendering to the blocks that are not empty with the opacity of the volume,
+   * computing the blocks when the array changed and classifying them when the opacity changed
+   */
+  void UpdateCropping(vtkImageData* input, vtkDataArray* array, vtkVolume* vol);
+
+  /**
+   * Use a coarser sample distance for the rendered image while interacting
+   */
+  void UpdateSampleDistance(vtkImageData* rendered);
+
+  /**
+   * Copy the rendering parameters to the internal mapper, without modifying it if unchanged
+   */
+  void UpdateDelegate();
+
+  int MemoryBudget = 0;
+  bool Interactive = false;
+  double InteractiveSampleDistanceFactor = 2.0;
+  int RenderedLevel = 0;
+
+  vtkSmartPointer<vtkF3DVolumeBlocks> Blocks;
+  vtkTimeStamp BlocksBuildTime;
+  vtkDataArray* BlocksArray = nullptr;
+  int BlocksComponent = -1;
+  vtkPiecewiseFunction* CroppingOpacity = nullptr;
+  vtkTimeStamp CroppingTime;
+
+  vtkNew<vtkSmartVolumeMapper> Delegate;
+  Region DisplayedRegion;
+  vtkTimeStamp DisplayedTime;
+
+  std::future<Extraction> PendingExtraction;
+  std::thread ExtractionThread;
+
+private:
+  vtkF3DVolumeLODMapper(const vtkF3DVolumeLODMapper&) = delete;
+  void operator=(const vtkF3DVolumeLODMapper&) = delete;
+};
+
+#endif